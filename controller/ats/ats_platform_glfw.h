@@ -1,7 +1,9 @@
 #pragma once
 
+#ifdef _WIN32
 #define WIN32_MEAN_AND_LEAN
 #include <windows.h>
+#endif
 
 #ifdef OPENGL_MODERN
 #include "glad/glad.h"
@@ -12,8 +14,10 @@
 
 #include <GLFW/glfw3.h>
 
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif
 
 
 #include <stdint.h>
@@ -82,7 +86,9 @@ static struct {
     //
     GLFWwindow*     window;
     GLFWmonitor*    monitor;
+#ifdef _WIN32
     HWND            native;
+#endif
     //
     int             fullscreen;
     int             _fullscreen_state_last_update;
@@ -221,7 +227,9 @@ static void PlatformInit(const char* title, int width, int height, int samples)
     platform.height = height;
     //
     platform.window = glfwCreateWindow(width, height, title, NULL, NULL);
+#ifdef _WIN32
     platform.native = glfwGetWin32Window(platform.window);
+#endif
 
     glfwSetWindowPos(platform.window, (mode->width - width) / 2, (mode->height - height) / 2);
 
@@ -319,6 +319,7 @@ static void RenderSetLightGlobalAmbient(float r, float g, float b)
 #ifndef ATS_NO_TEXTURE
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
 
 #include "stb/stb_image.h" 
 
@@ -2183,6 +2183,15 @@ static int CStringFind(const char *str, const char *item)
 
 // ==================================== FILES ==================================== //
 
+#ifndef _WIN32
+// the file functions use the windows fopen_s
+static int fopen_s(FILE **fp, const char *file_name, const char *mode)
+{
+    *fp = fopen(file_name, mode);
+    return *fp == NULL;
+}
+#endif
+
 static size_t FileGetSize(FILE *fp) {
     fseek(fp, 0L, SEEK_END);
     size_t size = ftell(fp);
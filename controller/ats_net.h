@@ -1,9 +1,12 @@
 #pragma once
 
 #include "../ats/ats_tool.h"
-#include <winsock2.h>
 
-#define LOCAL_HOST  ("127.0.0.1")
+// UDP sockets with Winsock on windows and BSD sockets everywhere else, the API is the same on both
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
 
 static WSADATA wsa_data;
 
@@ -17,11 +20,40 @@ static void NetDeinit()
     WSACleanup();
 }
 
+#define NetClose(socket) closesocket(socket)
+
+#else
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+typedef int SOCKET;
+
+#define INVALID_SOCKET (-1)
+
+static void NetInit()
+{
+}
+
+static void NetDeinit()
+{
+}
+
+#define NetClose(socket) close(socket)
+
+#endif
+
+#define LOCAL_HOST  ("127.0.0.1")
+
 typedef struct Server {
     SOCKET              socket;
     struct sockaddr_in  addr;
 } Server;
-        
+
 typedef struct Client {
     SOCKET              socket;
     struct sockaddr_in  addr;
@@ -29,7 +61,7 @@ typedef struct Client {
 
 static void NetServerInit(Server *server, int port)
 {
-    memset(server, 0, sizeof server);
+    memset(server, 0, sizeof *server);
 
     server->socket = socket(AF_INET, SOCK_DGRAM, 0);
 
@@ -46,19 +78,51 @@ static int NetServerRecv(Server *server, void *data, size_t data_size)
     return len;
 }
 
+// like NetServerRecv, the sender goes to 'from' so it can be answered with NetServerSend
+static int NetServerRecvFrom(Server *server, void *data, size_t data_size, struct sockaddr_in *from)
+{
+    socklen_t size = sizeof *from;
+
+    int len = recvfrom(server->socket, data, data_size, 0, (struct sockaddr *)from, &size);
+    return len;
+}
+
+static int NetServerSend(Server *server, const struct sockaddr_in *to, const void *data, size_t data_size)
+{
+    return sendto(server->socket, data, data_size, 0, (const struct sockaddr *)to, sizeof *to);
+}
+
 static void NetClientInit(Client *client, const char *ip, int port)
 {
-    memset(client, 0, sizeof client);
+    memset(client, 0, sizeof *client);
 
     client->socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
 
-    client->addr.sin_family              = AF_INET;
-    client->addr.sin_port                = htons(port);
-    client->addr.sin_addr.S_un.S_addr    = inet_addr(ip);
+    client->addr.sin_family         = AF_INET;
+    client->addr.sin_port           = htons(port);
+    client->addr.sin_addr.s_addr    = inet_addr(ip);
 }
 
 static int NetClientSend(Client *client, const void *data, size_t data_size)
 {
-    sendto(client->socket, data, data_size, 0, (struct sockaddr *)&client->addr, sizeof client->addr);
+    return sendto(client->socket, data, data_size, 0, (struct sockaddr *)&client->addr, sizeof client->addr);
+}
+
+// recv calls on the socket return right away, with -1 when nothing is waiting
+static void NetSetNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(socket, FIONBIO, &mode);
+#else
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+// a packet sent back to the client, -1 when none is waiting on a non blocking socket
+static int NetClientRecv(Client *client, void *data, size_t data_size)
+{
+    int len = recvfrom(client->socket, data, data_size, 0, NULL, 0);
+    return len;
 }
 
@@ -0,0 +1,3 @@
+#!/bin/sh
+gcc client.c -o client -std=gnu11 -O2 -lglfw -lGL -lGLU -lm
+gcc server.c -o server -std=gnu11 -O2 -lm
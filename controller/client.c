@@ -1,6 +1,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "ats/ats_tool.h"
 #include "ats/ats_net.h"
@@ -44,8 +45,181 @@ static void ControllerUpdate(Controller *c, float t)
     c->blink = CLAMP(c->blink, -1, 1);
 }
 
-int main(void)
+// ============================================ DEBUG IMAGES ============================================ //
+
+typedef struct DebugImage
+{
+    // the frame being put together
+    int         started;
+    uint16_t    frame;
+    uint64_t    received;       // a bit per fragment
+    int         count;
+    int         width;
+    int         height;
+    uint32_t    size;
+    uint8_t     data[DEBUG_IMAGE_MAX_FRAGMENTS * DEBUG_IMAGE_PAYLOAD];
+
+    // the last whole frame, one byte per tile or pixel
+    int         shown;
+    int         shown_width;
+    int         shown_height;
+    uint8_t     pixels[DEBUG_IMAGE_MAX_FRAGMENTS * DEBUG_IMAGE_PAYLOAD];
+    double      time;
+
+    uint32_t    completed;
+    uint32_t    incomplete;     // replaced by a newer frame before all fragments arrived
+} DebugImage;
+
+static DebugImage debug_images[DEBUG_IMAGE_KIND_COUNT];
+
+// decodes the data of a whole frame into the pixels that are shown
+static void DebugImageDecode(DebugImage *image, int kind)
 {
+    if (kind == DEBUG_IMAGE_TILEMAP)
+    {
+        int count = image->width * image->height;
+
+        if (count > (int)sizeof image->pixels) return;
+        if (DebugTilemapDecode(image->pixels, count, image->data, image->size) != count) return;
+    }
+    else
+    {
+        int width, height, channels;
+
+        unsigned char *pixels = stbi_load_from_memory(image->data, image->size, &width, &height, &channels, 1);
+
+        if (!pixels) return;
+
+        if (width != image->width || height != image->height || width * height > (int)sizeof image->pixels)
+        {
+            stbi_image_free(pixels);
+            return;
+        }
+
+        memcpy(image->pixels, pixels, width * height);
+        stbi_image_free(pixels);
+    }
+
+    image->shown        = 1;
+    image->shown_width  = image->width;
+    image->shown_height = image->height;
+    image->time         = glfwGetTime();
+    image->completed++;
+}
+
+static int DebugImageWhole(const DebugImage *image)
+{
+    uint64_t all = image->count == 64? ~0ull : (1ull << image->count) - 1;
+
+    return image->count && image->received == all;
+}
+
+// adds a valid fragment, a fragment of a newer frame drops what is left of the current one
+static void DebugImageAdd(const DebugImageFragment *f)
+{
+    DebugImage *image = &debug_images[f->kind];
+
+    if (!image->started || f->frame != image->frame)
+    {
+        if (image->started && (int16_t)(f->frame - image->frame) < 0) return;
+
+        if (image->started && image->received && !DebugImageWhole(image)) image->incomplete++;
+
+        image->started  = 1;
+        image->frame    = f->frame;
+        image->received = 0;
+        image->count    = f->count;
+        image->width    = f->width;
+        image->height   = f->height;
+        image->size     = f->image_size;
+    }
+
+    // the header has to agree with the first fragment of the frame, a frame that is already shown is done
+    if (f->count != image->count || f->image_size != image->size || DebugImageWhole(image)) return;
+    if ((uint32_t)f->index * DEBUG_IMAGE_PAYLOAD + f->size > image->size) return;
+
+    memcpy(image->data + f->index * DEBUG_IMAGE_PAYLOAD, f->data, f->size);
+    image->received |= 1ull << f->index;
+
+    if (DebugImageWhole(image)) DebugImageDecode(image, f->kind);
+}
+
+// the colors of the tilemap window on the car, indexed by the TileType of lib/common.cc
+static const float debug_tile_colors[8][3] = {
+    { 0.0f, 0.0f,  0.0f },      // none
+    { 0.0f, 0.0f,  1.0f },      // edge
+    { 0.0f, 1.0f,  0.0f },      // road
+    { 0.2f, 0.4f,  0.1f },      // road edge
+    { 1.0f, 0.4f,  0.0f },      // center
+    { 0.2f, 0.27f, 0.6f },      // lane center
+    { 1.0f, 1.0f,  1.0f },
+    { 1.0f, 1.0f,  1.0f },
+};
+
+static void DebugImageRender(int kind, float x, float y, float scale)
+{
+    const DebugImage *image = &debug_images[kind];
+
+    if (!image->shown) return;
+
+    float rad = 0.5f * scale;
+
+    for (int iy = 0; iy < image->shown_height; ++iy)
+    {
+        for (int ix = 0; ix < image->shown_width; ++ix)
+        {
+            int   value = image->pixels[iy * image->shown_width + ix];
+            float r, g, b;
+
+            if (kind == DEBUG_IMAGE_TILEMAP)
+            {
+                if (value == 0) continue;
+
+                r = debug_tile_colors[value][0];
+                g = debug_tile_colors[value][1];
+                b = debug_tile_colors[value][2];
+            }
+            else
+            {
+                // the edges are sparse, only what stands out of the JPEG noise is drawn
+                if (value < 48) continue;
+                r = g = b = value / 255.0f;
+            }
+
+            RenderSquare(x + ix * scale + rad, y + iy * scale + rad, 0, rad, r, g, b, 1.0f);
+        }
+    }
+
+    RenderStringFormat(x, y - 16, 0, 12, 16, 0.5f, 0.5f, 0.5f, 1.0f, "%s %.0f ms, %u/%u",
+                       kind == DEBUG_IMAGE_TILEMAP? "tilemap" : "edge", (glfwGetTime() - image->time) * 1000.0,
+                       image->completed, image->completed + image->incomplete);
+}
+
+// a random session id that is not 0, different for every start of the client
+static uint32_t ClientSessionId(void)
+{
+    uint32_t us = (uint32_t)(uint64_t)(glfwGetTime() * 1000000.0);
+    uint32_t id = (uint32_t)time(NULL) * 2654435761u ^ us ^ (uint32_t)rand();
+
+    return id? id : 1;
+}
+
+// without a change of the input a package is still sent this often, so the failsafe of the car (250 ms by default)
+// does not stop it. set with the first command line argument
+#define CLIENT_HEARTBEAT_MS (100)
+
+// a client with a higher priority takes the car over from one with a lower priority. set with the second argument
+#define CLIENT_PRIORITY     (1)
+
+int main(int argc, char **argv)
+{
+    int heartbeat_ms = argc > 1? atoi(argv[1]) : CLIENT_HEARTBEAT_MS;
+    int priority     = argc > 2? atoi(argv[2]) : CLIENT_PRIORITY;
+
+    if (heartbeat_ms < 1) heartbeat_ms = 1;
+
+    priority = CLAMP(priority, 0, 255);
+
     PlatformInit("CLIENT!", 800, 600, 8);
 
     RenderInit();
@@ -53,11 +227,28 @@ int main(void)
 
     Controller  controller  = {0};
     Client      client      = {0};
+    uint32_t    sequence    = 0;
+    uint32_t    session     = 0;
+
+    // the last package sent, see the send policy in the loop
+    Controller  sent            = {0};
+    double      sent_time       = -1;
+    int         sent_count      = 0;
+    int         sent_rate       = 0;
+    double      rate_time       = 0;
 
     const char *ip = "192.168.137.146";
     
     NetClientInit(&client, ip, 8888);
 
+    srand((unsigned)time(NULL));
+    session = ClientSessionId();
+    NetSetNonBlocking(client.socket);
+
+    Telemetry   telemetry       = {0};
+    int         has_telemetry   = 0;
+    double      telemetry_time  = 0;
+
     while (!platform.close)
     {
         float t = platform.time.delta;
@@ -67,9 +258,59 @@ int main(void)
 
         ControllerUpdate(&controller, t);
 
-        ControllerPackage cp = ControllerPackageCreate(controller);
+        // right away when the input changed, so the latency stays the same, otherwise only as a heartbeat
+        {
+            double now = glfwGetTime();
 
-        NetClientSend(&client, &cp, sizeof cp);
+            int changed = memcmp(&controller, &sent, sizeof (Controller)) != 0;
+            int due     = sent_time < 0 || (now - sent_time) * 1000.0 >= heartbeat_ms;
+
+            if (changed || due)
+            {
+                ControllerPackage cp = ControllerPackageCreate(controller, session, priority, 0, sequence++,
+                                                               (uint32_t)(uint64_t)(now * 1000000.0));
+
+                NetClientSend(&client, &cp, sizeof cp);
+
+                sent        = controller;
+                sent_time   = now;
+                sent_count++;
+            }
+
+            if (now - rate_time >= 1.0)
+            {
+                sent_rate   = sent_count;
+                sent_count  = 0;
+                rate_time   = now;
+            }
+        }
+
+        // everything the car sent since the last frame, only the newest telemetry is shown
+        {
+            static union
+            {
+                Telemetry           telemetry;
+                DebugImageFragment  fragment;
+            } packet;
+
+            int len;
+
+            while ((len = NetClientRecv(&client, &packet, sizeof packet)) > 0)
+            {
+                if (TelemetryValid(&packet.telemetry, len))
+                {
+                    if (has_telemetry && (int32_t)(packet.telemetry.sequence - telemetry.sequence) <= 0) continue;
+
+                    telemetry       = packet.telemetry;
+                    has_telemetry   = 1;
+                    telemetry_time  = glfwGetTime();
+                }
+                else if (DebugImageFragmentValid(&packet.fragment, len))
+                {
+                    DebugImageAdd(&packet.fragment);
+                }
+            }
+        }
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         RenderSetCameraOrtho(platform.width, platform.height, -1.0f, 1.0f);
@@ -77,10 +318,45 @@ int main(void)
         RenderStringFormat(12, 1 * 16, 0, 12, 16, 1.0f, 0.5f, 0.0f, 1.0f, "thrust:    %d", controller.thrust);
         RenderStringFormat(12, 2 * 16, 0, 12, 16, 1.0f, 0.5f, 0.0f, 1.0f, "steering:  %d", controller.steering);
         RenderStringFormat(12, 3 * 16, 0, 12, 16, 1.0f, 0.5f, 0.0f, 1.0f, "blink:     %d", controller.blink);
+        RenderStringFormat(12, 4 * 16, 0, 12, 16, 0.5f, 0.5f, 0.5f, 1.0f, "sent:      %d/s (heartbeat %d ms)",
+                           sent_rate, heartbeat_ms);
+        RenderStringFormat(12, 5 * 16, 0, 12, 16, 0.5f, 0.5f, 0.5f, 1.0f, "session:   %08x, priority %d", session, priority);
+
+        if (has_telemetry)
+        {
+            float age = (float)(glfwGetTime() - telemetry_time);
+
+            // grey when nothing came for a while
+            float c = age < 0.5f? 1.0f : 0.5f;
+
+            RenderStringFormat(12, 6 * 16,  0, 12, 16, 0.0f, c, c, 1.0f, "car blink: %d", telemetry.blink);
+            RenderStringFormat(12, 7 * 16,  0, 12, 16, 0.0f, c, c, 1.0f, "car pos:   %.3f", telemetry.pos / 1000.0f);
+            RenderStringFormat(12, 8 * 16,  0, 12, 16, 0.0f, c, c, 1.0f, "car type:  %d", telemetry.type);
+            RenderStringFormat(12, 9 * 16,  0, 12, 16, 0.0f, c, c, 1.0f, "frame:     %d ms", telemetry.frame_ms);
+            RenderStringFormat(12, 10 * 16, 0, 12, 16, 0.0f, c, c, 1.0f, "decision:  %d ms", telemetry.decision_ms);
+            RenderStringFormat(12, 11 * 16, 0, 12, 16, 0.0f, c, c, 1.0f, "link:      %s, acked %u of %u",
+                               (telemetry.flags & TELEMETRY_LINK_LOST)? "LOST" : "ok", telemetry.ack_sequence, sequence - 1);
+            RenderStringFormat(12, 12 * 16, 0, 12, 16, 0.0f, c, c, 1.0f, "telemetry: %.0f ms old", age * 1000.0f);
+        }
+        else
+        {
+            RenderStringFormat(12, 6 * 16, 0, 12, 16, 0.5f, 0.5f, 0.5f, 1.0f, "no telemetry");
+        }
+
+        DebugImageRender(DEBUG_IMAGE_TILEMAP, 12, 15 * 16, 6.0f);
+        DebugImageRender(DEBUG_IMAGE_EDGE, 270, 15 * 16, 2.0f);
 
         PlatformUpdate();
     }
 
+    // hands the car over, it stops right away and another client can take it
+    {
+        ControllerPackage cp = ControllerPackageCreate(controller, session, priority, CONTROLLER_RELEASE, sequence++,
+                                                       (uint32_t)(uint64_t)(glfwGetTime() * 1000000.0));
+
+        NetClientSend(&client, &cp, sizeof cp);
+    }
+
     NetDeinit();
 }
 
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stddef.h>
 #include "../lib/crc32.h"
 
 typedef struct Controller
@@ -8,21 +9,187 @@ typedef struct Controller
     int8_t  blink;
 } Controller;
 
+// changes whenever the layout of ControllerPackage does, packages of other versions are dropped
+#define CONTROLLER_PACKAGE_VERSION  (3)
+
+// the client gives up control, the car stops and any other client may take over
+#define CONTROLLER_RELEASE          (1 << 0)
+
+/* Only one client controls the car at a time, the session that first sent a package. Another session takes over
+*  when its priority is higher, when the session in control released it or when its packages stopped coming for the
+*  failsafe timeout. Packages of every other session are dropped.
+*/
+#pragma pack(push, 1)
 typedef struct ControllerPackage
 {
-    uint32_t        crc32;
+    uint32_t        crc32;          // of everything after it
     //
+    uint8_t         version;
+    uint8_t         priority;       // higher takes over from lower
+    uint8_t         flags;          // CONTROLLER_*
+    uint8_t         reserved;
+    uint32_t        session;        // picked at random by the client when it starts, never 0
+    uint32_t        sequence;       // counts up with every package of the session
+    uint32_t        time_us;        // client clock when it was sent, the low 32 bits of its microseconds
     Controller      controller;
 } ControllerPackage;
+#pragma pack(pop)
+
+static uint32_t
+ControllerPackageCode(const ControllerPackage *cp)
+{
+    return CRC32Code(&cp->version, sizeof (ControllerPackage) - offsetof(ControllerPackage, version));
+}
 
 static ControllerPackage
-ControllerPackageCreate(Controller controller)
+ControllerPackageCreate(Controller controller, uint32_t session, uint8_t priority, uint8_t flags, uint32_t sequence,
+                        uint32_t time_us)
 {
     ControllerPackage cp = {0};
 
-    cp.crc32        = CRC32Code(&controller, sizeof (Controller));
+    cp.version      = CONTROLLER_PACKAGE_VERSION;
+    cp.priority     = priority;
+    cp.flags        = flags;
+    cp.session      = session;
+    cp.sequence     = sequence;
+    cp.time_us      = time_us;
     cp.controller   = controller;
+    cp.crc32        = ControllerPackageCode(&cp);
 
     return cp;
 }
 
+// a package of 'size' bytes that is whole, unchanged and of this version
+static int
+ControllerPackageValid(const ControllerPackage *cp, int size)
+{
+    return size == sizeof (ControllerPackage) && cp->version == CONTROLLER_PACKAGE_VERSION &&
+           cp->crc32 == ControllerPackageCode(cp);
+}
+
+// ============================================ TELEMETRY ============================================ //
+
+// sent by the car to whoever sent the last ControllerPackage, TELEMETRY_RATE_HZ times a second
+#define TELEMETRY_VERSION       (1)
+#define TELEMETRY_RATE_HZ       (20)
+
+#define TELEMETRY_LINK_LOST     (1 << 0)
+
+#pragma pack(push, 1)
+typedef struct Telemetry
+{
+    uint32_t        crc32;          // of everything after it
+    //
+    uint8_t         version;
+    uint8_t         flags;          // TELEMETRY_*
+    int8_t          blink;
+    uint8_t         type;           // RoadState of the classification
+    uint32_t        sequence;       // counts up with every telemetry package
+    uint32_t        ack_sequence;   // of the last ControllerPackage the car applied
+    int16_t         pos;            // klass.pos in thousandths
+    uint16_t        decision_ms;    // of the last blink change
+    uint16_t        frame_ms;       // time of the last camera frame
+} Telemetry;
+#pragma pack(pop)
+
+static uint32_t
+TelemetryCode(const Telemetry *t)
+{
+    return CRC32Code(&t->version, sizeof (Telemetry) - offsetof(Telemetry, version));
+}
+
+static int
+TelemetryValid(const Telemetry *t, int size)
+{
+    return size == sizeof (Telemetry) && t->version == TELEMETRY_VERSION && t->crc32 == TelemetryCode(t);
+}
+
+// ============================================ DEBUG IMAGES ============================================ //
+
+// the images of the image processing, streamed by the car when it runs without a monitor. an image is split into
+// fragments that each fit one UDP packet, a frame is shown once all of its fragments arrived and replaced as soon as
+// a fragment of a newer frame shows up, lost fragments are never resent.
+#define DEBUG_IMAGE_VERSION         (1)
+#define DEBUG_IMAGE_PAYLOAD         (1024)      // image bytes in one fragment, a fragment stays below the usual MTU
+#define DEBUG_IMAGE_MAX_FRAGMENTS   (64)        // so an image is at most 64 KiB
+
+#define DEBUG_IMAGE_TILEMAP         (0)         // one byte per tile, see DebugTilemapEncode
+#define DEBUG_IMAGE_EDGE            (1)         // the edge image as a grayscale JPEG
+#define DEBUG_IMAGE_KIND_COUNT      (2)
+
+#pragma pack(push, 1)
+typedef struct DebugImageFragment
+{
+    uint32_t        crc32;          // of the header after it and the 'size' bytes of data
+    //
+    uint8_t         version;
+    uint8_t         kind;           // DEBUG_IMAGE_*
+    uint16_t        frame;          // counts up with every image of this kind
+    uint16_t        width;
+    uint16_t        height;
+    uint8_t         index;          // of this fragment
+    uint8_t         count;          // fragments of the image
+    uint16_t        size;           // bytes of data in this fragment
+    uint32_t        image_size;     // bytes of the whole image
+    //
+    uint8_t         data[DEBUG_IMAGE_PAYLOAD];
+} DebugImageFragment;
+#pragma pack(pop)
+
+#define DEBUG_IMAGE_HEADER_SIZE     (offsetof(DebugImageFragment, data))
+
+static uint32_t
+DebugImageFragmentCode(const DebugImageFragment *f)
+{
+    return CRC32Code(&f->version, DEBUG_IMAGE_HEADER_SIZE - offsetof(DebugImageFragment, version) + f->size);
+}
+
+// 'size' is what was received, only the header and the used part of data are sent
+static int
+DebugImageFragmentValid(const DebugImageFragment *f, int size)
+{
+    return size >= (int)DEBUG_IMAGE_HEADER_SIZE && f->version == DEBUG_IMAGE_VERSION &&
+           size == (int)DEBUG_IMAGE_HEADER_SIZE + f->size && f->size <= DEBUG_IMAGE_PAYLOAD &&
+           f->kind < DEBUG_IMAGE_KIND_COUNT && f->index < f->count && f->count <= DEBUG_IMAGE_MAX_FRAGMENTS &&
+           f->image_size <= (uint32_t)f->count * DEBUG_IMAGE_PAYLOAD && f->crc32 == DebugImageFragmentCode(f);
+}
+
+// run length coding of the tile types, a byte is the tile in the top 3 bits and the run length - 1 in the low 5.
+// returns the bytes written, -1 when it does not fit 'capacity'
+static int
+DebugTilemapEncode(uint8_t *dst, int capacity, const uint8_t *tiles, int count)
+{
+    int size = 0;
+
+    for (int i = 0; i < count;)
+    {
+        int tile = tiles[i] & 7;
+        int run  = 1;
+
+        while (run < 32 && i + run < count && (tiles[i + run] & 7) == tile) run++;
+
+        if (size == capacity) return -1;
+
+        dst[size++] = (uint8_t)((tile << 5) | (run - 1));
+        i += run;
+    }
+
+    return size;
+}
+
+// returns the tiles written, less than 'count' when the data is cut short
+static int
+DebugTilemapDecode(uint8_t *tiles, int count, const uint8_t *src, int size)
+{
+    int n = 0;
+
+    for (int i = 0; i < size && n < count; ++i)
+    {
+        int tile = src[i] >> 5;
+        int run  = (src[i] & 31) + 1;
+
+        while (run-- && n < count) tiles[n++] = (uint8_t)tile;
+    }
+
+    return n;
+}
@@ -10,14 +10,24 @@ int main(void)
 {
     NetInit();
 
-    Controller  controller  = {0};
-    Server      server      = {0};
+    ControllerPackage   cp      = {0};
+    Server              server  = {0};
 
     NetServerInit(&server, 8888);
 
     while (1) {
-        NetServerRecv(&server, &controller, sizeof controller);
+        int size = NetServerRecv(&server, &cp, sizeof cp);
 
+        if (!ControllerPackageValid(&cp, size)) {
+            puts("invalid package\n");
+            continue;
+        }
+
+        Controller controller = cp.controller;
+
+        printf("session:  %08x (priority %u%s)\n", cp.session, cp.priority,
+               (cp.flags & CONTROLLER_RELEASE)? ", released" : "");
+        printf("sequence: %u (%u us)\n", cp.sequence, cp.time_us);
         printf("thrust:   %d\n",   controller.thrust);
         printf("steering: %d\n",   controller.steering);
         printf("blink:    %d\n\n", controller.blink);
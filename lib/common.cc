@@ -237,38 +237,294 @@ enum
     TILE_LANE_CENTER
 };
 
+// NOTE(anton): every layer is its own contiguous plane of 'width * height' bytes. a stage only touches the planes it
+// needs and never overwrites what an earlier stage produced, so e.g. drawing the center does not destroy the road.
+typedef int TileLayer;
+enum
+{
+    LAYER_EDGE,         // number of edge pixels that fell in the tile, saturates at 255
+    LAYER_ROAD,         // TILE_ROAD where the road flood fill reached the tile
+    LAYER_BOUNDARY,     // TILE_ROAD_EDGE where the road flood fill was stopped
+    LAYER_OVERLAY,      // TILE_CENTER / TILE_LANE_CENTER drawn by the road analysis
+    LAYER_PREV_EDGE,    // edge state of the previous frame, kept by TilemapUpdateRoad
+
+    LAYER_COUNT
+};
+
+// summary pyramid over one layer of the tilemap. every cell of level 0 summarizes a 4x4 block of tiles, and every
+// cell of the next level a 4x4 block of the level below, as empty (no tile set), full (every tile set) or mixed.
+// scans and fills use it to step over uniform blocks instead of visiting every tile.
+#define PYRAMID_LEVELS  (2)
+#define PYRAMID_SHIFT   (2)
+
+typedef int Occupancy;
+enum
+{
+    OCC_EMPTY,
+    OCC_FULL,
+    OCC_MIXED
+};
+
+struct TilemapPyramid
+{
+    int32_t     width[PYRAMID_LEVELS];
+    int32_t     height[PYRAMID_LEVELS];
+    uint8_t     *cells[PYRAMID_LEVELS];
+};
+
+static int TilemapPyramidShift(int level)
+{
+    return PYRAMID_SHIFT * (level + 1);
+}
+
+// recomputes the cell of 'level' at cell coordinates 'cx', 'cy' from the level below (or from the layer for level 0).
+static void TilemapPyramidUpdateCell(TilemapPyramid *pyramid, const uint8_t *layer, int width, int height, int level, int cx, int cy)
+{
+    int has_set   = 0;
+    int has_unset = 0;
+
+    const int block = 1 << PYRAMID_SHIFT;
+
+    if (level == 0) {
+        int sx = cx * block;
+        int sy = cy * block;
+        int ex = CLAMP_MAX(sx + block, width);
+        int ey = CLAMP_MAX(sy + block, height);
+
+        for (int y = sy; y < ey; ++y) {
+            for (int x = sx; x < ex; ++x) {
+                if (layer[y * width + x]) has_set   = 1;
+                else                      has_unset = 1;
+            }
+        }
+    } else {
+        const uint8_t *below        = pyramid->cells[level - 1];
+        int            below_width  = pyramid->width[level - 1];
+        int            below_height = pyramid->height[level - 1];
+
+        int sx = cx * block;
+        int sy = cy * block;
+        int ex = CLAMP_MAX(sx + block, below_width);
+        int ey = CLAMP_MAX(sy + block, below_height);
+
+        for (int y = sy; y < ey; ++y) {
+            for (int x = sx; x < ex; ++x) {
+                int cell = below[y * below_width + x];
+
+                if (cell != OCC_EMPTY) has_set   = 1;
+                if (cell != OCC_FULL)  has_unset = 1;
+            }
+        }
+    }
+
+    pyramid->cells[level][cy * pyramid->width[level] + cx] = has_set? (has_unset? OCC_MIXED : OCC_FULL) : OCC_EMPTY;
+}
+
+static void TilemapPyramidBuild(TilemapPyramid *pyramid, const uint8_t *layer, int width, int height)
+{
+    for (int level = 0; level < PYRAMID_LEVELS; ++level) {
+        int block = 1 << TilemapPyramidShift(level);
+
+        pyramid->width[level]  = (width  + block - 1) / block;
+        pyramid->height[level] = (height + block - 1) / block;
+        pyramid->cells[level]  = (uint8_t *)realloc(pyramid->cells[level], pyramid->width[level] * pyramid->height[level]);
+
+        for (int cy = 0; cy < pyramid->height[level]; ++cy) {
+            for (int cx = 0; cx < pyramid->width[level]; ++cx) {
+                TilemapPyramidUpdateCell(pyramid, layer, width, height, level, cx, cy);
+            }
+        }
+    }
+}
+
+// call after changing a single tile of the layer, recomputes the cells that contain it.
+static void TilemapPyramidUpdate(TilemapPyramid *pyramid, const uint8_t *layer, int width, int height, int x, int y)
+{
+    for (int level = 0; level < PYRAMID_LEVELS; ++level) {
+        int shift = TilemapPyramidShift(level);
+
+        TilemapPyramidUpdateCell(pyramid, layer, width, height, level, x >> shift, y >> shift);
+    }
+}
+
+// returns the occupancy of the largest uniform block that contains the tile and sets 'size' to its size in tiles,
+// or returns OCC_MIXED with 'size' 1 if only mixed blocks contain the tile.
+static int TilemapPyramidGetBlock(const TilemapPyramid *pyramid, int x, int y, int *size)
+{
+    for (int level = PYRAMID_LEVELS - 1; level >= 0; --level) {
+        int shift = TilemapPyramidShift(level);
+        int cell  = pyramid->cells[level][(y >> shift) * pyramid->width[level] + (x >> shift)];
+
+        if (cell != OCC_MIXED) {
+            *size = 1 << shift;
+            return cell;
+        }
+    }
+
+    *size = 1;
+    return OCC_MIXED;
+}
+
 struct Tilemap
 {
     int32_t     width;
     int32_t     height;
     int32_t     cell_size;
-    uint8_t     *tiles;
+
+    // all layers live in one allocation owned by 'edge'.
+    uint8_t     *edge;
+    uint8_t     *road;
+    uint8_t     *boundary;
+    uint8_t     *overlay;
+    uint8_t     *prev_edge;
+
+    // set while 'prev_edge' and the road layers belong to the previous frame of the same size, see TilemapUpdateRoad.
+    int32_t     has_prev;
+    int32_t     prev_start_x;
+    int32_t     prev_start_y;
+
+    // sum of the sub-tile x offsets of the edge pixels in a tile, in 1/256 of a tile. together with the edge
+    // density it gives the x centroid of the edges inside the tile.
+    uint16_t    *edge_x;
+
+    // chamfer distance from every road tile to the nearest non-road tile, see TilemapDistanceTransform.
+    uint16_t    *dist;
+
+    // summaries of the edge and road layers, both are rebuilt by TilemapFloodFillRoad.
+    TilemapPyramid  edge_pyramid;
+    TilemapPyramid  road_pyramid;
+
+    // set while 'road_pyramid' matches the road layer. anything else that writes the road layer clears it, the road
+    // scans then read the layer itself, see TilemapGetRoadBlock.
+    int32_t     has_road_pyramid;
 };
 
+static uint8_t *TilemapLayer(const Tilemap *map, TileLayer layer)
+{
+    return map->edge + layer * (map->width * map->height);
+}
+
+static size_t TilemapLayersSize(const Tilemap *map)
+{
+    return (map->width * map->height) * (LAYER_COUNT * sizeof *map->edge + sizeof *map->edge_x + sizeof *map->dist);
+}
+
+// returns the layer a tile type is stored in.
+static uint8_t *TilemapLayerOf(const Tilemap *map, int tile)
+{
+    switch (tile) {
+        case TILE_EDGE:         return map->edge;
+        case TILE_ROAD:         return map->road;
+        case TILE_ROAD_EDGE:    return map->boundary;
+        case TILE_CENTER:
+        case TILE_LANE_CENTER:  return map->overlay;
+    }
+
+    return NULL;
+}
+
+static bool TilemapIsEdge(const Tilemap *map, int x, int y)
+{
+    return map->edge[y * map->width + x] != 0;
+}
+
+static bool TilemapIsRoad(const Tilemap *map, int x, int y)
+{
+    return map->road[y * map->width + x] != 0;
+}
+
+// call after writing the road layer outside of TilemapFloodFillRoad and TilemapUpdateRoad, the road pyramid and the
+// road TilemapUpdateRoad would patch do not match it anymore.
+static void TilemapRoadChanged(Tilemap *map)
+{
+    map->has_road_pyramid   = 0;
+    map->has_prev           = 0;
+}
+
+// like TilemapPyramidGetBlock on the road pyramid, a single tile of the road layer while the pyramid is not valid.
+static int TilemapGetRoadBlock(const Tilemap *map, int x, int y, int *size)
+{
+    if (map->has_road_pyramid)
+        return TilemapPyramidGetBlock(&map->road_pyramid, x, y, size);
+
+    *size = 1;
+    return TilemapIsRoad(map, x, y)? OCC_FULL : OCC_EMPTY;
+}
+
+// returns the tile as it should be drawn: overlay over boundary over road over edge.
 static int TilemapGet(const Tilemap *map, int x, int y)
 {
-    return map->tiles[y * map->width + x];
+    int index = y * map->width + x;
+
+    if (map->overlay[index])    return map->overlay[index];
+    if (map->boundary[index])   return TILE_ROAD_EDGE;
+    if (map->road[index])       return TILE_ROAD;
+    if (map->edge[index])       return TILE_EDGE;
+
+    return TILE_NONE;
 }
 
+// sets the tile in the layer the tile type belongs to, TILE_NONE clears the tile in every layer.
 static void TilemapSet(Tilemap *map, int x, int y, int tile)
 {
-    map->tiles[y * map->width + x] = tile;
+    int index = y * map->width + x;
+
+    if (tile == TILE_NONE || tile == TILE_ROAD)
+        TilemapRoadChanged(map);
+
+    if (tile == TILE_NONE) {
+        for (int layer = 0; layer <= LAYER_OVERLAY; ++layer) {
+            TilemapLayer(map, layer)[index] = 0;
+        }
+
+        return;
+    }
+
+    TilemapLayerOf(map, tile)[index] = (tile == TILE_EDGE)? 255 : tile;
 }
 
 static void TilemapClear(Tilemap *map)
 {
-    memset(map->tiles, 0, (map->width * map->height) * sizeof *map->tiles);
+    memset(map->edge, 0, TilemapLayersSize(map));
+
+    TilemapRoadChanged(map);
+}
+
+// clearing the edge layer also clears the edge centroids.
+static void TilemapClearLayer(Tilemap *map, TileLayer layer)
+{
+    memset(TilemapLayer(map, layer), 0, (map->width * map->height) * sizeof *map->edge);
+
+    if (layer == LAYER_ROAD)
+        TilemapRoadChanged(map);
+
+    if (layer == LAYER_EDGE)
+        memset(map->edge_x, 0, (map->width * map->height) * sizeof *map->edge_x);
 }
 
 static void TilemapResize(Tilemap *map, int image_width, int image_height, int cell_size)
 {
+    int width  = image_width  / cell_size;
+    int height = image_height / cell_size;
+
+    if (width != map->width || height != map->height)
+        TilemapRoadChanged(map);
+
     map->cell_size  = cell_size;
-    map->width      = image_width  / map->cell_size;
-    map->height     = image_height / map->cell_size;
-    map->tiles      = (decltype(map->tiles))realloc(map->tiles, map->width * map->height * sizeof *map->tiles);
+    map->width      = width;
+    map->height     = height;
+    map->edge       = (uint8_t *)realloc(map->edge, TilemapLayersSize(map));
+
+    map->road       = TilemapLayer(map, LAYER_ROAD);
+    map->boundary   = TilemapLayer(map, LAYER_BOUNDARY);
+    map->overlay    = TilemapLayer(map, LAYER_OVERLAY);
+    map->prev_edge  = TilemapLayer(map, LAYER_PREV_EDGE);
+    map->edge_x     = (uint16_t *)TilemapLayer(map, LAYER_COUNT);
+    map->dist       = map->edge_x + (map->width * map->height);
 }
 
-static void TilemapFillEdges(Tilemap *map, const unsigned char *data, int width, int height, int marker = TILE_EDGE)
+// accumulates the edge density and the edge centroid of every tile into the edge layer.
+static void TilemapFillEdges(Tilemap *map, const unsigned char *data, int width, int height)
 {
     float inv_cell_size = 1.0f / map->cell_size;
 
@@ -278,108 +534,403 @@ static void TilemapFillEdges(Tilemap *map, const unsigned char *data, int width,
                 int tx = CLAMP(x * inv_cell_size, 0, map->width - 1);
                 int ty = CLAMP(y * inv_cell_size, 0, map->height - 1);
 
-                map->tiles[ty * map->width + tx] = marker;
+                int index = ty * map->width + tx;
+
+                if (map->edge[index] < 255) {
+                    // pixel centers in 1/256 of a tile: (x - tile_x + 0.5) / cell_size
+                    int sub_x = ((2 * (x - tx * map->cell_size) + 1) * 128) / map->cell_size;
+
+                    map->edge[index]++;
+                    map->edge_x[index] += CLAMP(sub_x, 0, 255);
+                }
             }
         }
     }
 }
 
-static void TilemapFloodFill(Tilemap* dst, const Tilemap *map, int start_x, int start_y, int marker = TILE_ROAD)
+// returns the x centroid of the edge pixels in the tile in tile units, or the center of the tile if it has no edges.
+static float TilemapGetEdgeCentroid(const Tilemap *map, int x, int y)
 {
-    struct Point { int x, y; };
+    int index = y * map->width + x;
 
-    static Point *point_stack   = NULL;
+    if (!map->edge[index])
+        return x + 0.5f;
 
-    point_stack = (Point *)realloc(point_stack, map->width * map->height * sizeof (Point));
+    return x + map->edge_x[index] / (256.0f * map->edge[index]);
+}
 
-    int point_count = 0;
+// describes how the camera sees the road, used to bin edges into a bird's-eye tilemap.
+struct CameraCalibration
+{
+    float   focal;          // focal length in pixels
+    float   center_x;       // principal point in pixels
+    float   center_y;
+    float   pitch;          // downwards tilt of the camera in radians
+    float   height;         // height of the camera above the road
+
+    // the part of the road covered by the tilemap, in the same unit as 'height'.
+    float   ground_width;   // centered on the camera
+    float   ground_near;    // distance from the camera to the bottom row of the tilemap
+    float   ground_far;     // distance from the camera to the top row of the tilemap
+};
 
-    point_stack[point_count++] = { start_x, start_y };
+#define TILE_REMAP_NONE (0xFFFFFFFF)
 
-    int start_tile = map->tiles[start_y * map->width + start_x];
+// image pixel to tile lookup table, computed once from the camera calibration.
+// every entry is the fixed-point tile x and y of the point on the road that the pixel sees: the tile index in the top
+// 24 bits and the sub-tile x in 1/256 of a tile in the low 8 bits, or TILE_REMAP_NONE if the pixel does not see the
+// covered part of the road.
+// NOTE: the remap is a forward mapping, so 'ground_far' has to stay close enough that the far rows still get at least
+// one pixel per tile, or edges up there turn into dotted lines that the road fill leaks through.
+struct TileRemap
+{
+    int32_t     image_width;
+    int32_t     image_height;
+    int32_t     cell_size;
 
-    while (point_count) {
-        Point current = point_stack[--point_count];
+    uint32_t    *lut;
+};
+
+// the remap uses the same grid as TilemapResize with the same image size and 'cell_size', so the tilemap keeps its
+// size and only what the tiles cover changes.
+static void TileRemapCreate(TileRemap *remap, const CameraCalibration *camera, int image_width, int image_height, int cell_size)
+{
+    int tiles_x = image_width  / cell_size;
+    int tiles_y = image_height / cell_size;
+
+    remap->image_width  = image_width;
+    remap->image_height = image_height;
+    remap->cell_size    = cell_size;
+    remap->lut          = (uint32_t *)realloc(remap->lut, image_width * image_height * sizeof *remap->lut);
+
+    float sin_pitch = sinf(camera->pitch);
+    float cos_pitch = cosf(camera->pitch);
+
+    for (int y = 0; y < image_height; ++y) {
+        for (int x = 0; x < image_width; ++x) {
+            uint32_t entry = TILE_REMAP_NONE;
+
+            // ray through the pixel center in camera space, rotated by the pitch and intersected with the road.
+            float dx    = (x + 0.5f - camera->center_x) / camera->focal;
+            float dy    = (y + 0.5f - camera->center_y) / camera->focal;
+            float denom = dy * cos_pitch + sin_pitch;
+
+            if (denom > 1e-6f) {
+                float t  = camera->height / denom;
+                float gx = t * dx;
+                float gz = t * (cos_pitch - dy * sin_pitch);
+
+                float tx = (gx / camera->ground_width + 0.5f) * tiles_x;
+                float ty = (camera->ground_far - gz) / (camera->ground_far - camera->ground_near) * tiles_y;
+
+                if (tx >= 0.0f && tx < tiles_x && ty >= 0.0f && ty < tiles_y) {
+                    int tile_x = tx;
+                    int tile_y = ty;
+                    int sub_x  = CLAMP_MAX((int)((tx - tile_x) * 256.0f), 255);
+
+                    entry = ((tile_y * tiles_x + tile_x) << 8) | sub_x;
+                }
+            }
+
+            remap->lut[y * image_width + x] = entry;
+        }
+    }
+}
 
-        dst->tiles[current.y * map->width + current.x] = marker;
+// same as TilemapFillEdges, but the edges are binned through the remap into a bird's-eye tilemap. costs one table
+// lookup per edge pixel.
+static void TilemapFillEdgesRemap(Tilemap *map, const TileRemap *remap, const unsigned char *data)
+{
+    int size = remap->image_width * remap->image_height;
+
+    for (int i = 0; i < size; ++i) {
+        if (!data[i]) continue;
 
-        const Point ns[4] = {
-            current.x,     current.y - 1,
-            current.x,     current.y + 1,
-            current.x - 1, current.y,
-            current.x + 1, current.y
-        };
+        uint32_t entry = remap->lut[i];
 
-        for (int i = 0; i < ARRAY_COUNT(ns); ++i) {
-            Point n = ns[i];
+        if (entry == TILE_REMAP_NONE) continue;
 
-            if (n.x < 0 || n.x >= map->width)  continue;
-            if (n.y < 0 || n.y >= map->height) continue;
-            if (dst->tiles[n.y * map->width + n.x] == marker)     continue;
-            if (start_tile != map->tiles[n.y * map->width + n.x]) continue;
+        int index = entry >> 8;
 
-            point_stack[point_count++] = n;
+        if (map->edge[index] < 255) {
+            map->edge[index]++;
+            map->edge_x[index] += entry & 0xFF;
         }
     }
 }
 
-static void TilemapFloodFillRoad(Tilemap* dst, const Tilemap *map, int start_x, int start_y)
+// fills the road layer starting at 'start'. the fill spreads over the tiles that have the same edge state as the
+// start tile, and every tile that stops it is marked in the boundary layer.
+// blocks of the edge pyramid that are uniformly fillable are filled at once, only their border is walked tile by tile.
+static void TilemapFloodFillRoad(Tilemap *map, int start_x, int start_y)
 {
     struct Point { int x, y; };
 
-    static Point *point_stack   = NULL;
+    static Point    *point_stack    = NULL;
+    static uint8_t  *block_done     = NULL;
+
+    // the road no longer matches what TilemapUpdateRoad saw last.
+    map->has_prev = 0;
+
+    TilemapPyramidBuild(&map->edge_pyramid, map->edge, map->width, map->height);
+
+    const TilemapPyramid *pyramid = &map->edge_pyramid;
+
+    int block_count = pyramid->width[0] * pyramid->height[0] + pyramid->width[1] * pyramid->height[1];
 
     point_stack = (Point *)realloc(point_stack, map->width * map->height * sizeof (Point));
+    block_done  = (uint8_t *)realloc(block_done, block_count);
+
+    memset(block_done, 0, block_count);
 
     int point_count = 0;
 
-    point_stack[point_count++] = { start_x, start_y };
+    bool start_edge = TilemapIsEdge(map, start_x, start_y);
+    int  fill_block = start_edge? OCC_FULL : OCC_EMPTY;
 
-    int start_tile = map->tiles[start_y * map->width + start_x];
+    // tiles are marked when pushed so that no tile is pushed twice and the stack can never overflow.
+    map->road[start_y * map->width + start_x] = TILE_ROAD;
+    point_stack[point_count++] = { start_x, start_y };
 
     while (point_count) {
         Point current = point_stack[--point_count];
 
-        dst->tiles[current.y * map->width + current.x] = TILE_ROAD;
+        int size = 1;
 
-        const Point ns[4] = {
-            current.x,     current.y - 1,
-            current.x,     current.y + 1,
-            current.x - 1, current.y,
-            current.x + 1, current.y
-        };
+        if (TilemapPyramidGetBlock(pyramid, current.x, current.y, &size) != fill_block)
+            size = 1;
 
-        for (int i = 0; i < ARRAY_COUNT(ns); ++i) {
-            Point n = ns[i];
+        int sx = current.x;
+        int sy = current.y;
+        int ex = current.x;
+        int ey = current.y;
 
-            if (n.x < 0 || n.x >= map->width)  continue;
-            if (n.y < 0 || n.y >= map->height) continue;
+        if (size > 1) {
+            int level = (size == (1 << TilemapPyramidShift(0)))? 0 : 1;
+            int shift = TilemapPyramidShift(level);
+            int done  = (level? pyramid->width[0] * pyramid->height[0] : 0) + (current.y >> shift) * pyramid->width[level] + (current.x >> shift);
 
-            if (dst->tiles[n.y * map->width + n.x] == TILE_ROAD) continue;
+            if (block_done[done]) continue;
 
-            if (start_tile != map->tiles[n.y * map->width + n.x]) {
-                dst->tiles[n.y * map->width + n.x] = TILE_ROAD_EDGE;
-                continue;
+            block_done[done] = 1;
+
+            sx = (current.x >> shift) << shift;
+            sy = (current.y >> shift) << shift;
+            ex = CLAMP_MAX(sx + size, map->width)  - 1;
+            ey = CLAMP_MAX(sy + size, map->height) - 1;
+
+            for (int y = sy; y <= ey; ++y) {
+                memset(&map->road[y * map->width + sx], TILE_ROAD, ex - sx + 1);
             }
+        }
+
+        // the neighbours of the filled area: the tiles just outside its border.
+        for (int side = 0; side < 4; ++side) {
+            int count = (side < 2)? (ex - sx + 1) : (ey - sy + 1);
+
+            for (int i = 0; i < count; ++i) {
+                Point n;
+
+                switch (side) {
+                    case 0: n = { sx + i, sy - 1 }; break;
+                    case 1: n = { sx + i, ey + 1 }; break;
+                    case 2: n = { sx - 1, sy + i }; break;
+                    case 3: n = { ex + 1, sy + i }; break;
+                }
 
-            point_stack[point_count++] = n;
+                if (n.x < 0 || n.x >= map->width)  continue;
+                if (n.y < 0 || n.y >= map->height) continue;
+
+                int index = n.y * map->width + n.x;
+
+                if (map->road[index]) continue;
+
+                if (start_edge != (map->edge[index] != 0)) {
+                    map->boundary[index] = TILE_ROAD_EDGE;
+                    continue;
+                }
+
+                map->road[index] = TILE_ROAD;
+                point_stack[point_count++] = n;
+            }
         }
     }
+
+    TilemapPyramidBuild(&map->road_pyramid, map->road, map->width, map->height);
+
+    map->has_road_pyramid = 1;
+}
+
+static bool TilemapIsRoadSafe(const Tilemap *map, int x, int y)
+{
+    if (x < 0 || x >= map->width || y < 0 || y >= map->height) return false;
+
+    return TilemapIsRoad(map, x, y);
+}
+
+// recomputes the boundary flag of a tile: an edge tile next to the road.
+static void TilemapUpdateBoundary(Tilemap *map, int x, int y)
+{
+    if (x < 0 || x >= map->width || y < 0 || y >= map->height) return;
+
+    bool next_to_road = TilemapIsRoadSafe(map, x, y - 1) || TilemapIsRoadSafe(map, x, y + 1) ||
+                        TilemapIsRoadSafe(map, x - 1, y) || TilemapIsRoadSafe(map, x + 1, y);
+
+    map->boundary[y * map->width + x] = (TilemapIsEdge(map, x, y) && next_to_road)? TILE_ROAD_EDGE : 0;
+}
+
+// returns true if removing the road tile can not split the road: all road tiles next to it are connected through
+// the ring of 8 tiles around it.
+static bool TilemapIsRoadRemovable(const Tilemap *map, int x, int y)
+{
+    // clockwise from the tile above, the even entries are the direct neighbours.
+    const int ring_x[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    const int ring_y[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+    bool ring[8];
+
+    for (int i = 0; i < 8; ++i) {
+        ring[i] = TilemapIsRoadSafe(map, x + ring_x[i], y + ring_y[i]);
+    }
+
+    // count the runs of road around the ring that touch the tile through a direct neighbour.
+    int runs = 0;
+
+    for (int i = 0; i < 8; i += 2) {
+        if (!ring[i]) continue;
+
+        // only count the run once, at its first direct neighbour going clockwise.
+        int prev = (i + 7) % 8;
+        int prev_direct = (i + 6) % 8;
+
+        if (ring[prev] && ring[prev_direct]) continue;
+
+        runs++;
+    }
+
+    // a ring that is road all around has no first direct neighbour.
+    if (!runs && ring[0] && ring[2] && ring[4] && ring[6])
+        runs = 1;
+
+    return runs == 1;
+}
+
+// updates the road and boundary layers after the edge layer was filled for a new frame.
+//
+// consecutive frames give almost the same edges, so if at most 'max_changes' tiles changed their edge state since
+// the last call, the previous road is patched around the changed tiles instead of being filled again. a change that
+// could connect the road to a new area or split it apart falls back to a full fill, so the result is always the same
+// as TilemapFloodFillRoad.
+// returns the number of patched tiles, or -1 if the road was filled again.
+static int TilemapUpdateRoad(Tilemap *map, int start_x, int start_y, int max_changes)
+{
+    static int *changes = NULL;
+
+    int size = map->width * map->height;
+
+    changes = (int *)realloc(changes, (max_changes + 1) * sizeof *changes);
+
+    int  change_count = 0;
+    bool patch        = map->has_prev && map->prev_start_x == start_x && map->prev_start_y == start_y;
+
+    for (int i = 0; patch && i < size; ++i) {
+        if ((map->edge[i] != 0) != (map->prev_edge[i] != 0)) {
+            if (change_count == max_changes) {
+                patch = false;
+                break;
+            }
+
+            changes[change_count++] = i;
+        }
+    }
+
+    // patching only handles a road that was and still is filled over free space.
+    if (patch && (TilemapIsEdge(map, start_x, start_y) || map->prev_edge[start_y * map->width + start_x]))
+        patch = false;
+
+    for (int c = 0; patch && c < change_count; ++c) {
+        int x = changes[c] % map->width;
+        int y = changes[c] / map->width;
+
+        if (TilemapIsEdge(map, x, y)) {
+            // a road tile turned into an edge, the road only loses the tile if that does not split it.
+            if (TilemapIsRoad(map, x, y)) {
+                if (!TilemapIsRoadRemovable(map, x, y)) {
+                    patch = false;
+                    break;
+                }
+
+                map->road[changes[c]] = 0;
+            }
+        } else {
+            // an edge turned into free space next to the road, the road grows into it unless that opens it up to
+            // free space that is not road yet.
+            bool next_to_road = TilemapIsRoadSafe(map, x, y - 1) || TilemapIsRoadSafe(map, x, y + 1) ||
+                                TilemapIsRoadSafe(map, x - 1, y) || TilemapIsRoadSafe(map, x + 1, y);
+
+            if (next_to_road) {
+                const int ns_x[4] = { 0, 0, -1, 1 };
+                const int ns_y[4] = { -1, 1, 0, 0 };
+
+                for (int i = 0; i < 4; ++i) {
+                    int nx = x + ns_x[i];
+                    int ny = y + ns_y[i];
+
+                    if (nx < 0 || nx >= map->width || ny < 0 || ny >= map->height) continue;
+
+                    if (!TilemapIsEdge(map, nx, ny) && !TilemapIsRoad(map, nx, ny))
+                        patch = false;
+                }
+
+                if (!patch) break;
+
+                map->road[changes[c]] = TILE_ROAD;
+            }
+        }
+
+        TilemapUpdateBoundary(map, x, y);
+        TilemapUpdateBoundary(map, x, y - 1);
+        TilemapUpdateBoundary(map, x, y + 1);
+        TilemapUpdateBoundary(map, x - 1, y);
+        TilemapUpdateBoundary(map, x + 1, y);
+
+        TilemapPyramidUpdate(&map->edge_pyramid, map->edge, map->width, map->height, x, y);
+        TilemapPyramidUpdate(&map->road_pyramid, map->road, map->width, map->height, x, y);
+    }
+
+    if (!patch) {
+        TilemapClearLayer(map, LAYER_ROAD);
+        TilemapClearLayer(map, LAYER_BOUNDARY);
+        TilemapFloodFillRoad(map, start_x, start_y);
+    }
+
+    for (int i = 0; i < size; ++i) {
+        map->prev_edge[i] = map->edge[i] != 0;
+    }
+
+    map->has_prev       = 1;
+    map->prev_start_x   = start_x;
+    map->prev_start_y   = start_y;
+
+    return patch? change_count : -1;
 }
 
 static void TilemapDialate(Tilemap *map, int tile_type)
 {
-    static int *old = NULL;
+    static uint8_t *old = NULL;
+
+    uint8_t *layer = TilemapLayerOf(map, tile_type);
+
+    if (layer == map->road)
+        TilemapRoadChanged(map);
 
-    old = (int *)realloc(old, map->width * map->height * sizeof (int));
+    old = (uint8_t *)realloc(old, map->width * map->height * sizeof *old);
 
-    memcpy(old, map->tiles, map->width * map->height * sizeof (int));
+    memcpy(old, layer, map->width * map->height * sizeof *old);
 
     for (int ty = 0; ty < map->height; ++ty) {
         for (int tx = 0; tx < map->width; ++tx) {
-            int tile = TilemapGet(map, tx, ty);
-
-            if (tile != tile_type) {
+            if (!old[ty * map->width + tx]) {
                 int sx = CLAMP_MIN(tx - 1, 0);
                 int sy = CLAMP_MIN(ty - 1, 0);
                 int ex = CLAMP_MAX(tx + 1, map->width - 1);
@@ -387,7 +938,7 @@ static void TilemapDialate(Tilemap *map, int tile_type)
 
                 for (int y = sy; y <= ey; ++y) {
                     for (int x = sx; x <= ex; ++x) {
-                        if (old[y * map->width + x] == tile_type) {
+                        if (old[y * map->width + x]) {
                             TilemapSet(map, tx, ty, tile_type);
                         }
                     }
@@ -399,17 +950,20 @@ static void TilemapDialate(Tilemap *map, int tile_type)
 
 static void TilemapErode(Tilemap *map, int tresh, int tile_type)
 {
-    static int *old = NULL;
+    static uint8_t *old = NULL;
+
+    uint8_t *layer = TilemapLayerOf(map, tile_type);
 
-    old = (int *)realloc(old, map->width * map->height * sizeof (int));
+    if (layer == map->road)
+        TilemapRoadChanged(map);
 
-    memcpy(old, map->tiles, map->width * map->height * sizeof (int));
+    old = (uint8_t *)realloc(old, map->width * map->height * sizeof *old);
+
+    memcpy(old, layer, map->width * map->height * sizeof *old);
 
     for (int ty = 0; ty < map->height; ++ty) {
         for (int tx = 0; tx < map->width; ++tx) {
-            int tile = TilemapGet(map, tx, ty);
-
-            if (tile == tile_type) {
+            if (old[ty * map->width + tx]) {
                 int sx = CLAMP_MIN(tx - 1, 0);
                 int sy = CLAMP_MIN(ty - 1, 0);
                 int ex = CLAMP_MAX(tx + 1, map->width - 1);
@@ -421,14 +975,14 @@ static void TilemapErode(Tilemap *map, int tresh, int tile_type)
                     for (int x = sx; x <= ex; ++x) {
                         if (x == tx && y == ty) continue;
 
-                        if (old[y * map->width + x] == tile_type) {
+                        if (old[y * map->width + x]) {
                             adj_count++;
                         }
                     }
                 }
 
                 if (adj_count < tresh) {
-                    TilemapSet(map, tx, ty, TILE_NONE);
+                    layer[ty * map->width + tx] = 0;
                 }
             }
         }
@@ -441,7 +995,7 @@ static void TilemapDrawLine(Tilemap *map, v2 start, v2 end, int pen = TILE_EDGE)
     v2 iter = start;
 
     while (DistSq(iter, end) > 1.0f) {
-        TilemapSet(map, iter.x, iter.y, TILE_EDGE);
+        TilemapSet(map, iter.x, iter.y, pen);
 
         iter.x += 0.5f * dir.x;
         iter.y += 0.5f * dir.y;
@@ -461,8 +1015,12 @@ enum
 static int TilemapGetRoadHeight(const Tilemap *map)
 {
     for (int y = 0; y < map->height; ++y) {
-        for (int x = 0; x < map->width; ++x) {
-            if (TilemapGet(map, x, y) == TILE_ROAD)
+        int size = 1;
+
+        for (int x = 0; x < map->width; x = ((x / size) + 1) * size) {
+            int block = TilemapGetRoadBlock(map, x, y, &size);
+
+            if (block == OCC_FULL || (block == OCC_MIXED && TilemapIsRoad(map, x, y)))
                 return y;
         }
     }
@@ -470,22 +1028,85 @@ static int TilemapGetRoadHeight(const Tilemap *map)
     return 0;
 }
 
-static float TilemapGetRoadPosition(const Tilemap *map, RoadState state)
+// returns the position of the car on the road, -1 to 1 from the left to the right road edge.
+//
+// the road edges are found with sub-tile precision: where the road is stopped by a tile with edges the edge is placed
+// at the x centroid of the edge pixels in that tile, and the more edge pixels the tile has the more the row is trusted.
+// the center and width of the bottom 'rows' rows are then fitted with a weighted line and evaluated at the bottom row,
+// so the position is no longer quantized to whole tiles and coarser cells can be used.
+static float TilemapGetRoadPosition(const Tilemap *map, RoadState state, int rows = 4)
 {
-    float   center     = 0.5f * map->width;
-    int     road_left  = 0;
-    int     road_right = map->width - 1;
+    float sum_w  = 0.0f;
+    float sum_y  = 0.0f;
+    float sum_yy = 0.0f;
+    float sum_c  = 0.0f;
+    float sum_yc = 0.0f;
+    float sum_h  = 0.0f;
+    float sum_yh = 0.0f;
+
+    for (int y = CLAMP_MIN(map->height - rows, 0); y < map->height; ++y) {
+        int road_left  = 0;
+        int road_right = map->width - 1;
+
+        while (road_left < map->width && !TilemapIsRoad(map, road_left, y)) {
+            road_left++;
+        }
+
+        while (road_right >= 0 && !TilemapIsRoad(map, road_right, y)) {
+            road_right--;
+        }
+
+        if (road_left > road_right) continue;
+
+        float left   = road_left;
+        float right  = road_right + 1;
+        float weight = 1.0f;
+
+        if (road_left > 0 && TilemapIsEdge(map, road_left - 1, y)) {
+            left    = TilemapGetEdgeCentroid(map, road_left - 1, y);
+            weight += CLAMP_MAX((float)map->edge[y * map->width + road_left - 1] / map->cell_size, 1.0f);
+        }
 
-    while (road_left < map->height && TilemapGet(map, road_left, map->height - 1) != TILE_ROAD) {
-        road_left++;
+        if (road_right < map->width - 1 && TilemapIsEdge(map, road_right + 1, y)) {
+            right   = TilemapGetEdgeCentroid(map, road_right + 1, y);
+            weight += CLAMP_MAX((float)map->edge[y * map->width + road_right + 1] / map->cell_size, 1.0f);
+        }
+
+        float row_y     = y + 0.5f;
+        float center    = 0.5f * (left + right);
+        float half      = 0.5f * (right - left);
+
+        sum_w  += weight;
+        sum_y  += weight * row_y;
+        sum_yy += weight * row_y * row_y;
+        sum_c  += weight * center;
+        sum_yc += weight * row_y * center;
+        sum_h  += weight * half;
+        sum_yh += weight * row_y * half;
     }
 
-    while (road_right >= 0 && TilemapGet(map, road_right, map->height - 1) != TILE_ROAD) {
-        road_right--;
+    if (sum_w == 0.0f)
+        return 0.0f;
+
+    float road_center = sum_c / sum_w;
+    float road_half   = sum_h / sum_w;
+
+    float det = sum_w * sum_yy - sum_y * sum_y;
+
+    // a single row (or rows with equal weight at one y) can not be fitted, the weighted mean is used then.
+    if (det > 1e-3f) {
+        float bottom       = map->height - 0.5f;
+        float slope_center = (sum_w * sum_yc - sum_y * sum_c) / det;
+        float slope_half   = (sum_w * sum_yh - sum_y * sum_h) / det;
+
+        road_center += slope_center * (bottom - sum_y / sum_w);
+        road_half   += slope_half   * (bottom - sum_y / sum_w);
     }
 
-    float road_center = 0.5f * (road_right + road_left);
-    float road_position = (center - road_center) / (0.5f * (road_right - road_left));
+    if (road_half <= 0.0f)
+        return 0.0f;
+
+    float road_position = (0.5f * map->width - road_center) / road_half;
 
     return road_position;
 
@@ -498,60 +1119,158 @@ static float TilemapGetRoadPosition(const Tilemap *map, RoadState state)
 #endif
 }
 
-// draw the center of the road into the 'dst' tilemap.
+#define CHAMFER_ORTHO   (3)
+#define CHAMFER_DIAG    (4)
+
+// two-pass 3-4 chamfer distance transform of the road layer into 'map->dist', O(n) with integer math only.
+// every road tile gets the distance to the nearest non-road tile in 1/3 tiles, non-road tiles get 0.
+// the left and right border of the map count as non-road, the top and bottom are left open since the road continues
+// beyond them.
+static void TilemapDistanceTransform(Tilemap *map)
+{
+    const int width  = map->width;
+    const int height = map->height;
+
+    uint16_t *dist = map->dist;
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int index = y * width + x;
+
+            if (!map->road[index]) {
+                dist[index] = 0;
+                continue;
+            }
+
+            int d = (x > 0? dist[index - 1] : 0) + CHAMFER_ORTHO;
+
+            if (y > 0) {
+                int nw = x > 0?         dist[index - width - 1] : 0;
+                int ne = x < width - 1? dist[index - width + 1] : 0;
+
+                d = CLAMP_MAX(d, dist[index - width] + CHAMFER_ORTHO);
+                d = CLAMP_MAX(d, nw + CHAMFER_DIAG);
+                d = CLAMP_MAX(d, ne + CHAMFER_DIAG);
+            }
+
+            dist[index] = d;
+        }
+    }
+
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = width - 1; x >= 0; --x) {
+            int index = y * width + x;
+
+            if (!dist[index]) continue;
+
+            int d = dist[index];
+
+            d = CLAMP_MAX(d, (x < width - 1? dist[index + 1] : 0) + CHAMFER_ORTHO);
+
+            if (y < height - 1) {
+                int sw = x > 0?         dist[index + width - 1] : 0;
+                int se = x < width - 1? dist[index + width + 1] : 0;
+
+                d = CLAMP_MAX(d, dist[index + width] + CHAMFER_ORTHO);
+                d = CLAMP_MAX(d, sw + CHAMFER_DIAG);
+                d = CLAMP_MAX(d, se + CHAMFER_DIAG);
+            }
+
+            dist[index] = d;
+        }
+    }
+}
+
+static int TilemapGetDist(const Tilemap *map, int x, int y)
+{
+    if (x < 0 || x >= map->width || y < 0 || y >= map->height) return 0;
+
+    return map->dist[y * map->width + x];
+}
+
+// returns true if the tile is on the medial ridge of the distance transform. a tile is on the ridge if it is a maximum
+// across x, which follows roads going up, or a maximum across y that is not on a slope along x, which follows roads
+// going to the sides without picking up the steps of a curved road edge.
+// on plateaus of equal distance only the first tile counts.
+static bool TilemapIsRidge(const Tilemap *map, int x, int y)
+{
+    int d     = TilemapGetDist(map, x, y);
+    int left  = TilemapGetDist(map, x - 1, y);
+    int right = TilemapGetDist(map, x + 1, y);
+
+    if (!d) return false;
+
+    if (d > left && d >= right) return true;
+
+    int up   = (y > 0)?               TilemapGetDist(map, x, y - 1) : d;
+    int down = (y < map->height - 1)? TilemapGetDist(map, x, y + 1) : d;
+
+    return d > up && d >= down && d >= left && d >= right;
+}
+
+// draw the center of the road into the overlay layer. the center is the medial ridge of the distance transform, so
+// it follows curves and the branches of intersections, and the lane centers are drawn halfway between the center and
+// the road edge.
 // returns a float between 0.0f - 1.0f, that reprecents the precentage of the center that was not part of the road.
-static float TilemapDrawRoadCenter(Tilemap *dst, const Tilemap *map, int center_width = 0)
+static float TilemapDrawRoadCenter(Tilemap *map, int center_width = 0)
 {
     int tiles_total = 0;
     int tiles_edge  = 0;
 
+    TilemapDistanceTransform(map);
+
     int height = TilemapGetRoadHeight(map);
 
     for (int y = height; y < map->height; ++y) {
-        int left  = 0.5f * map->width;
-        int right = 0.5f * map->width;
-
         for (int x = 0; x < map->width; ++x) {
-            if (TilemapGet(map, x, y) == TILE_ROAD) {
-                if (x < left)  left  = x;
-                if (x > right) right = x;
-            }
-        }
+            if (!TilemapIsRidge(map, x, y)) continue;
 
-        int center       = 0.5f * (left  + right);
-        int left_center  = 0.5f * (left  + center);
-        int right_center = 0.5f * (right + center);
+            int lane = (TilemapGetDist(map, x, y) + CHAMFER_ORTHO) / (2 * CHAMFER_ORTHO);
 
-        TilemapSet(dst, left_center,  y, TILE_LANE_CENTER);
-        TilemapSet(dst, right_center, y, TILE_LANE_CENTER);
+            if (lane > 0) {
+                int left_center  = x - lane;
+                int right_center = x + lane;
 
-        int start = center - center_width;
-        int end   = center + center_width;
+                if (left_center  >= 0         && !map->overlay[y * map->width + left_center])
+                    TilemapSet(map, left_center,  y, TILE_LANE_CENTER);
 
-        for (int i = start; i <= end; ++i) {
-            tiles_total++;
+                if (right_center < map->width && !map->overlay[y * map->width + right_center])
+                    TilemapSet(map, right_center, y, TILE_LANE_CENTER);
+            }
+
+            int start = CLAMP_MIN(x - center_width, 0);
+            int end   = CLAMP_MAX(x + center_width, map->width - 1);
 
-            if (TilemapGet(map, i, y) == TILE_EDGE)
-                tiles_edge++;
+            for (int i = start; i <= end; ++i) {
+                tiles_total++;
 
-            TilemapSet(dst, i, y, TILE_CENTER);
+                if (TilemapIsEdge(map, i, y))
+                    tiles_edge++;
+
+                TilemapSet(map, i, y, TILE_CENTER);
+            }
         }
     }
 
     return tiles_total? (float)tiles_edge / (float)tiles_total : 0.0f;
 }
 
+// the road scans below step over uniform blocks of the road pyramid, a road/non-road change can only happen at the
+// first tile of a uniform block so only that tile has to be looked at.
+
 static bool TilemapIsRoadHorizontalAt(const Tilemap *map, int x)
 {
-    int prev_tile   = TILE_NONE;
+    bool prev_road = false;
+    int  size      = 1;
 
-    for (int y = 0; y < map->height; ++y) {
-        int tile = TilemapGet(map, x, y);
+    for (int y = 0; y < map->height; y = ((y / size) + 1) * size) {
+        int  block = TilemapGetRoadBlock(map, x, y, &size);
+        bool road  = (block == OCC_MIXED)? TilemapIsRoad(map, x, y) : (block == OCC_FULL);
 
-        if (prev_tile == TILE_ROAD && tile != TILE_ROAD)
+        if (prev_road && !road)
             return true;
 
-        prev_tile = tile;
+        prev_road = road;
     }
 
     return false;
@@ -562,14 +1281,21 @@ static bool TilemapIsRoadVerticalAt(const Tilemap *map, int y)
     bool edge_left  = false;
     bool edge_right = false;
 
-    for (int x = 1; x < map->width - 1; ++x) {
-        if (TilemapGet(map, x, y) == TILE_ROAD && TilemapGet(map, x - 1, y) != TILE_ROAD) { 
+    bool prev_road  = false;
+    int  size       = 1;
+
+    for (int x = 0; x < map->width; x = ((x / size) + 1) * size) {
+        int  block = TilemapGetRoadBlock(map, x, y, &size);
+        bool road  = (block == OCC_MIXED)? TilemapIsRoad(map, x, y) : (block == OCC_FULL);
+
+        // road starting at x, or road ending at x - 1, away from the border of the map.
+        if (road && !prev_road && x >= 1 && x <= map->width - 2)
             edge_left  = true;
-        }
 
-        if (TilemapGet(map, x, y) == TILE_ROAD && TilemapGet(map, x + 1, y) != TILE_ROAD) {
+        if (!road && prev_road && x - 1 >= 1 && x - 1 <= map->width - 2)
             edge_right = true;
-        }
+
+        prev_road = road;
     }
 
     return edge_left && edge_right;
@@ -589,5 +1315,3 @@ static RoadState TilemapGetRoadState(const Tilemap *map)
 
     return result;
 }
-
-
@@ -12,10 +12,30 @@ static cv::Mat  mat_tiles;
 
 static Tilemap  map;
 
+// the edge, tilemap, hough_lines and and windows, off when the images are streamed instead
+static bool     image_proc_windows = true;
+
+// bin the edges through the inverse perspective remap so the tilemap is a bird's-eye view of the road.
+// the calibration is a rough guess for the 320x240 camera on the car and has to be measured before this is turned on.
+static bool                 use_remap   = false;
+static TileRemap            remap;
+static CameraCalibration    camera      = {
+    277.0f,             // focal, ~60 degrees horizontal fov
+    160.0f, 120.0f,     // center
+    0.35f,              // pitch, ~20 degrees
+    0.15f,              // height
+
+    1.0f,               // ground_width
+    0.25f,              // ground_near
+    1.5f,               // ground_far
+};
+
 static void ImageProcInit(void)
 {
     hough_lines.reserve(1028 * 512);
 
+    if (!image_proc_windows) return;
+
     cv::namedWindow("edge", cv::WINDOW_NORMAL);
     cv::namedWindow("tilemap", cv::WINDOW_NORMAL);
     cv::namedWindow("hough_lines", cv::WINDOW_NORMAL);
@@ -27,21 +47,41 @@ static InterPos ImageProcUpdate(const cv::Mat &frame)
     MatToEdge(mat_edge, frame);
 
     TilemapResize(&map, mat_edge.cols, mat_edge.rows, 8);
-    TilemapClear(&map);
 
-    TilemapFillEdges(&map, mat_edge.ptr(), mat_edge.cols, mat_edge.rows);
+    // the road layers are kept from the last frame so TilemapUpdateRoad can patch them.
+    TilemapClearLayer(&map, LAYER_EDGE);
+    TilemapClearLayer(&map, LAYER_OVERLAY);
 
-    TilemapFloodFillRoad(&map, &map, map.width / 2, map.height - 1);
+    if (use_remap) {
+        if (remap.image_width != mat_edge.cols || remap.image_height != mat_edge.rows || remap.cell_size != map.cell_size)
+            TileRemapCreate(&remap, &camera, mat_edge.cols, mat_edge.rows, map.cell_size);
+
+        TilemapFillEdgesRemap(&map, &remap, mat_edge.ptr());
+    } else {
+        TilemapFillEdges(&map, mat_edge.ptr(), mat_edge.cols, mat_edge.rows);
+    }
+
+    TilemapUpdateRoad(&map, map.width / 2, map.height - 1, (map.width * map.height) / 32);
 
     // road edge masking and hough lines
     {
         mat_and = cv::Mat::zeros(mat_edge.rows, mat_edge.cols, CV_8UC1);
 
-        for (int y = 0; y < map.height; ++y) {
-            for (int x = 0; x < map.width; ++x) {
-                int tile = TilemapGet(&map, x, y);
+        if (use_remap) {
+            // the tiles are not image rectangles anymore, so the mask goes through the remap per pixel.
+            unsigned char *mask = mat_and.ptr();
+
+            for (int i = 0; i < mat_edge.cols * mat_edge.rows; ++i) {
+                uint32_t entry = remap.lut[i];
 
-                if (tile == TILE_ROAD_EDGE) {
+                if (entry != TILE_REMAP_NONE && map.boundary[entry >> 8])
+                    mask[i] = 255;
+            }
+        }
+
+        for (int y = 0; !use_remap && y < map.height; ++y) {
+            for (int x = 0; x < map.width; ++x) {
+                if (map.boundary[y * map.width + x]) {
                     cv::Point a = { (int)(map.cell_size * x), (int)(map.cell_size * y) };
                     cv::Point b = a + cv::Point(map.cell_size, map.cell_size);
 
@@ -57,13 +97,15 @@ static InterPos ImageProcUpdate(const cv::Mat &frame)
     RoadState state = TilemapGetRoadState(&map);
     float     pos   = TilemapGetRoadPosition(&map, state);
 
-    TilemapDrawRoadCenter(&map, &map, 0);
+    TilemapDrawRoadCenter(&map, 0);
     
     return { state, pos };
 }
 
 static void ImageProcRender(void)
 {
+    if (!image_proc_windows) return;
+
     // get hough_lines:
     if (1) {
         mat_lines = cv::Mat::zeros(mat_edge.rows, mat_edge.cols, CV_8UC3);
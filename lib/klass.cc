@@ -1,5 +1,9 @@
+#pragma once
+
 // ============================================ KLASSIFICATION ============================================== //
 
+#include "stats.cc"
+
 /*Pos
 *    -1 -> 1//left -> right
 */
@@ -16,174 +20,330 @@ struct InterPos {
 	float pos;
 };
 
-struct InterPosList {
-	static const int maxSize = 10;
-	static const int typeTypes = 10;
-	static const int difListSize = (int)maxSize * 0.5;
-	static const int typeThreshold = (int)maxSize * 0.8;
+/* The tunable values of the classification, the defaults are the hand-picked ones the car drives with.
+*/
+struct KlassParams {
+	int window = 10;				// samples in the pos average and the type counts
+	int diffWindow = 5;				// samples spanned by posDifAvg
+	int typePercent = 80;			// share of the window a type needs before it is taken over
+	double turnPos = 0.5;			// pos beyond which a 4-way intersection blinks
+	double turnHysteresis = 0.1;	// how far back inside turnPos the pos has to come to stop that blink
+	double laneChangeDif = 0.03;	// posDifAvg beyond +-laneChangeDif blinks right or left when changing lanes
+
+	int entryFrames = 2;			// frames a blink has to be decided in a row before the blinker turns on
+	int exitFrames = 3;				// frames another decision (off or the other side) has to hold to change it
+	int minHoldFrames = 10;			// frames the blinker keeps a state at least
+
+	// the same in milliseconds for TimedInterPosList, the defaults are the frame counts above at 30 fps
+	int windowMs = 330;
+	int diffWindowMs = 165;
+	int entryMs = 66;
+	int exitMs = 100;
+	int minHoldMs = 330;
+	int frameMs = 33;				// posDifAvg is the change per frameMs, so laneChangeDif keeps its meaning
+};
+
+/* The blink decision of a single frame from the window statistics, shared by InterPosList and InterPosBatch.
+*  Written with masks instead of branches or selects so the batch version vectorizes across streams.
+*
+*    3 up and left       left when the pos is left of the center, else straight on
+*    5 up and right      right when the pos is right of the center, else straight on
+*    6 left and right    the side of the pos
+*    7 4-way             beyond +-turnPos, a turn that already blinks keeps blinking until the pos is turnHysteresis
+*                        back inside turnPos
+*    8 two lanes         right when posDifAvg is above laneChangeDif, left when it is below -laneChangeDif, else the
+*                        current output
+*
+*  The other types keep the current output 'blink'. Until the window is full the current output counts as off.
+*  The thresholds are float like the pos, so every caller compares in float and InterPosBatch keeps 8 lanes to a
+*  vector.
+*/
+static inline int KlassDecide(int type, float pos, float posDifAvg, int blink, bool full,
+							   float turnPos = 0.5f, float laneChangeDif = 0.03f, float turnHysteresis = 0) {
+	blink &= -(int)full;
+
+	int isLeft = -(pos < 0);
+	int isRight = -(pos > 0);
+
+	int leftUp = isLeft;
+	int rightUp = -isRight;
+	int leftRight = 1 | ~isRight;
 
-	InterPos list[maxSize];
-	int index = 0;
+	float holdPos = turnPos - turnHysteresis;
+
+	int right = (pos > turnPos) | ((pos > holdPos) & (blink == 1));
+	int left = (pos < -turnPos) | ((pos < -holdPos) & (blink == -1));
+	int fourWay = right - left;
+
+	int laneChange = (posDifAvg > laneChangeDif) - (posDifAvg < -laneChangeDif);
+	int twoLanes = laneChange | (blink & -(laneChange == 0));
+
+	int is3 = -(type == 3);
+	int is5 = -(type == 5);
+	int is6 = -(type == 6);
+	int is7 = -(type == 7);
+	int is8 = -(type == 8);
+	int isOther = ~(is3 | is5 | is6 | is7 | is8);
+
+	return (leftUp & is3) | (rightUp & is5) | (leftRight & is6) | (fourWay & is7) | (twoLanes & is8) |
+		   (blink & isOther);
+}
+
+/* The states of the blinker output, see KlassHold.
+*/
+enum BlinkState {
+	BLINK_IDLE,			// off and no blink decided
+	BLINK_ENTERING,		// off, a blink is decided but not for entryFrames yet
+	BLINK_ACTIVE,		// blinking as decided
+	BLINK_EXITING,		// blinking, something else is decided but not for exitFrames yet
+};
+
+/* Moves the blinker 'state' and 'output' towards the per-frame decision 'raw' with hysteresis:
+*
+*    IDLE -> ENTERING when a blink is decided, ENTERING -> ACTIVE after entryFrames frames of the same blink
+*    ACTIVE -> EXITING when something else is decided, EXITING -> IDLE or the other side after exitFrames frames
+*    ENTERING falls back to IDLE and EXITING to ACTIVE when the decision goes back before that
+*
+*  and the output never changes less than minHoldFrames after its last change. candidateFrames counts the frames the
+*  same decision came in a row, a decision for the other side starts it over.
+*
+*  decisionFrames is the frames to decision of the last change: the frames between the decision first showing up and
+*  the output following it, 0 when it followed on the same frame.
+*
+*  'step' is how much a frame counts, TimedInterPosList passes the milliseconds since the last frame and then all the
+*  counts are milliseconds.
+*/
+static inline void KlassHold(int raw, int &state, int &output, int &candidate, int &candidateFrames, int &holdFrames,
+							 int &decisionFrames, int entryFrames, int exitFrames, int minHoldFrames, int step = 1) {
+	candidateFrames = raw == candidate? candidateFrames + step : step;
+	candidate = raw;
+	holdFrames += step;
+
+	// the decision of this frame
+	switch (state) {
+	case BLINK_IDLE:
+		if (raw != 0) state = BLINK_ENTERING;
+		break;
+	case BLINK_ENTERING:
+		if (raw == 0) state = BLINK_IDLE;
+		break;
+	case BLINK_ACTIVE:
+		if (raw != output) state = BLINK_EXITING;
+		break;
+	case BLINK_EXITING:
+		if (raw == output) state = BLINK_ACTIVE;
+		break;
+	}
+
+	// and how long it held
+	int need = state == BLINK_ENTERING? entryFrames : exitFrames;
+
+	if ((state == BLINK_ENTERING || state == BLINK_EXITING) && candidateFrames >= need &&
+		holdFrames >= minHoldFrames) {
+		output = raw;
+		state = raw? BLINK_ACTIVE : BLINK_IDLE;
+		decisionFrames = candidateFrames - step;
+		holdFrames = 0;
+	}
+}
+
+/* Window and DiffWindow are fixed at compile time for the car, InterPosListDynamic sets them at runtime with init()
+*  for tuning. Both share this implementation.
+*/
+template <int Window = 10, int DiffWindow = Window / 2>
+struct InterPosList {
+	StreamStats<Window, DiffWindow> posStats;
+	TypeCounts<Window> typeStats;
 	int size = 0;
 
 	//position
 	float pos = 0;
-	float posSum = 0;
 
 	//type of intersection/road scenario
 	int type = 0;
-	
-	
+
 	//Difference in pos
-	float posPrev = 0;
-	float difList[difListSize];
-	int difListIndex = 0;
 	float posDifAvg = 0;
 
 	//-1 left blink//1 right blink//0 no blink
 	int blink = 0;
 
-	void push(InterPos newInput) {
-		//at size 10
-		if (size == maxSize) {
-
-			list[index] = newInput;
-
-			/* Pos average */
-			posSum = 0;
-			int typeCheck[typeTypes];
-			for(InterPos a : list){
-				posSum += a.pos;
-				typeCheck[a.type]++;
-				if(typeCheck[a.type] > typeThreshold) type = a.type;
-			}
-			pos = posSum / maxSize;
-			//
-
-			//-----pos difference-----///
-			difList[difListIndex] = newInput.pos - posPrev;
-			float posDifSum = 0;
-			
-			for (float dif : difList) {
-				posDifSum += dif;
-			}
-			posDifAvg = posDifSum / difListSize;
-
-			posPrev = list[index].pos;
-			difListIndex = (++difListIndex) % difListSize;
-			///-----------------------////
-
-			index = (++index) % maxSize;
-		}
-
-		// at size 9
-		else if (size == (maxSize-1)) {
+	// hysteresis of the blink, see KlassHold
+	int blinkState = BLINK_IDLE;
+	int candidate = 0;
+	int candidateFrames = 0;
+	int holdFrames = 0;
+	int decisionFrames = 0;
+
+	// thresholds, see KlassParams
+	int typePercent = 80;
+	double turnPos = 0.5;
+	double turnHysteresis = 0.1;
+	double laneChangeDif = 0.03;
+	int entryFrames = 2;
+	int exitFrames = 3;
+	int minHoldFrames = 10;
+
+	InterPosList() {
+		init(Window? Window : 10, DiffWindow? DiffWindow : 5);
+	}
 
-			list[index] = newInput;
-		
-			difList[difListIndex] = newInput.pos - posPrev;
-			float posDifSum = 0;
-			for (float dif : difList) {
-				posDifSum += dif;
-			}
-			posDifAvg = posDifSum / difListSize;
+	// resets the list with the default thresholds, the window sizes only change for DYNAMIC_WINDOW
+	void init(int window, int difWindow) {
+		KlassParams params;
+		params.window = window;
+		params.diffWindow = difWindow;
 
-			posPrev = list[index].pos;
+		init(params);
+	}
 
-			index = (++index) % maxSize;
-			difListIndex = (++difListIndex) % difListSize;
-			size++;
-		}
-		//size below 9
-		else {
-			list[index] = newInput;
-
-			if (size != 0) {
-				difList[difListIndex] = newInput.pos - posPrev;
-				difListIndex = (++difListIndex) % difListSize;
-			}
-			if (size >= difListSize) {
-				float posDifSum = 0;
-				for (float dif : difList) {
-					posDifSum += dif;
-				}
-				posDifAvg = posDifSum / difListSize;
-			}
-			
-			posPrev = list[index].pos;
-			index++;
-			size++;
-		}
+	// resets the list, the window sizes in params only apply to DYNAMIC_WINDOW
+	void init(const KlassParams &params) {
+		posStats.init(params.window, params.diffWindow, 2.0f / (params.window + 1));
+		typeStats.init(params.window);
+
+		typePercent = params.typePercent;
+		turnPos = params.turnPos;
+		turnHysteresis = params.turnHysteresis;
+		laneChangeDif = params.laneChangeDif;
+		entryFrames = params.entryFrames;
+		exitFrames = params.exitFrames;
+		minHoldFrames = params.minHoldFrames;
+
+		size = 0;
+		pos = 0;
+		type = 0;
+		posDifAvg = 0;
+		blink = 0;
+
+		blinkState = BLINK_IDLE;
+		candidate = 0;
+		candidateFrames = 0;
+		holdFrames = minHoldFrames;
+		decisionFrames = 0;
 	}
 
-	int difAvg(){
-		return 0;
+	int maxSize() const {
+		return posStats.window.get();
 	}
-	int posAvg(){
-		if(pos > 0) return 1;
-		else return -1;
+
+	// a type needs more than typePercent of the window, 80% by default
+	int typeThreshold() const {
+		return maxSize() * typePercent / 100;
 	}
 
-	bool safeCheck(InterPos in){
+	void push(InterPos newInput) {
+		posStats.push(newInput.pos);
+		typeStats.push(newInput.type);
 
-		float dif = in.pos - pos;
-		dif = std::abs(dif);
-		if( dif > 1) return false;
-		else return true;
+		/* Pos average */
+		pos = posStats.mean();
 
-	}
+		/* Type needs a clear majority of the window to change */
+		if (typeStats.get(newInput.type) > typeThreshold()) type = newInput.type;
+
+		//-----pos difference-----///
+		posDifAvg = posStats.derivative();
 
+		if (size < maxSize()) size++;
+	}
 
+	// decides the blink of this frame and moves the output towards it
 	int analyze() {
-		if(size != maxSize) blink = 0;
-
-		switch (type) {
-		case 3:
-			blink = leftUp();
-		case 4:
-
-		case 5:
-			blink = rightUp();
-		case 6:
-			blink = leftRight();
-		case 7:
-			blink = leftRightUp();
-        case 8:
-            twoFiles();
-        }
-		
+		int raw = KlassDecide(type, pos, posDifAvg, blink, size == maxSize(), turnPos, laneChangeDif, turnHysteresis);
+
+		KlassHold(raw, blinkState, blink, candidate, candidateFrames, holdFrames, decisionFrames,
+				  entryFrames, exitFrames, minHoldFrames);
+
 		return blink;
 	}
 
-	/*
-		Threeway intersecion
-	*/
-	int leftRight() {
-		if (pos > 0) return 1;
-		else return -1;
+	BlinkState state() const {
+		return (BlinkState)blinkState;
+	}
+};
+
+typedef InterPosList<DYNAMIC_WINDOW, DYNAMIC_WINDOW> InterPosListDynamic;
+
+/* InterPosList with windows and hold times in milliseconds instead of frames, for a variable frame rate.
+*  Every sample comes with a monotonic timestamp, a window covers the same time however many frames fell into it, so
+*  frames can be dropped under load without retuning. posDifAvg is scaled to the change per frameMs to keep the meaning
+*  of laneChangeDif.
+*/
+struct TimedInterPosList {
+	TimedStats<> posStats;
+	TimedTypeCounts<> typeStats;
+
+	KlassParams params;
+
+	uint32_t startTime = 0;
+	uint32_t lastTime = 0;
+	int elapsed = 0;		// milliseconds since the previous sample
+	bool started = false;
+
+	float pos = 0;
+	int type = 0;
+	float posDifAvg = 0;
+	int blink = 0;
+
+	// hysteresis of the blink in milliseconds, see KlassHold
+	int blinkState = BLINK_IDLE;
+	int candidate = 0;
+	int candidateMs = 0;
+	int holdMs = KlassParams().minHoldMs;
+	int decisionMs = 0;
+
+	void init(const KlassParams &newParams) {
+		*this = TimedInterPosList();
+
+		params = newParams;
+
+		posStats.init(params.windowMs, params.diffWindowMs);
+		typeStats.init(params.windowMs);
+
+		holdMs = params.minHoldMs;
 	}
 
-	int leftUp() {
-		if (pos < 0) return -1;
-		else return 0;
+	// the window has seen a whole windowMs, the newest sample counting as one frame
+	bool full() const {
+		return started && lastTime - startTime + params.frameMs >= (uint32_t)params.windowMs;
 	}
 
-	int rightUp() {
-		if (pos < 0) return 1;
-		else return 0;
+	void push(InterPos newInput, uint32_t timeMs) {
+		if (!started) {
+			startTime = timeMs;
+			lastTime = timeMs;
+			started = true;
+		}
+
+		elapsed = (int)(timeMs - lastTime);
+		lastTime = timeMs;
+
+		posStats.push(timeMs, newInput.pos);
+		typeStats.push(timeMs, newInput.type);
+
+		pos = posStats.mean();
+
+		// a type needs more than typePercent of the samples in the window, like in InterPosList
+		if (full() && typeStats.get(newInput.type) > typeStats.size() * params.typePercent / 100) type = newInput.type;
+
+		posDifAvg = posStats.derivative() * params.frameMs;
 	}
 
+	int analyze() {
+		int raw = KlassDecide(type, pos, posDifAvg, blink, full(), params.turnPos, params.laneChangeDif,
+							  params.turnHysteresis);
+
+		// the first frame counts as one frameMs
+		int step = elapsed? elapsed : params.frameMs;
+
+		KlassHold(raw, blinkState, blink, candidate, candidateMs, holdMs, decisionMs,
+				  params.entryMs, params.exitMs, params.minHoldMs, step);
 
-	//4-wayintersection
-	int leftRightUp() {
-		if (pos > 0.5) return 1;
-		else if (pos < -0.5)  return -1;
-		else return 0;
+		return blink;
 	}
 
-	//File change
-	void twoFiles() {
-		if (posDifAvg > -0.03) blink = -1;
-		else if (posDifAvg > 0.03) blink = 1;
+	BlinkState state() const {
+		return (BlinkState)blinkState;
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+// ============================================ BATCH KLASSIFICATION ============================================== //
+
+#include "klass.cc"
+
+/* Runs InterPosList over many independent InterPos streams at once, for evaluating the classifier offline.
+*
+*  All streams advance one sample per step, so the window bookkeeping (head, fill level, what leaves the window) is
+*  shared and every per-stream update is the same straight-line code over an array of lanes. The lane loops have no
+*  branches, so gcc -O3 -march=haswell vectorizes them: 8 lanes per instruction for the float and int work, 4 for the
+*  double sums that keep the pos exactly the one of StreamStats. At -O2 gcc leaves them scalar, its cheapest cost
+*  model does not vectorize loops of a runtime length. The type count update, a scatter into each lane's own counts,
+*  and the blinker state machine of KlassHold stay scalar.
+*
+*  The results are exactly the ones of one InterPosList per stream.
+*
+*  Input and output are structure of arrays, time major: sample t of lane l is at [t * laneCount + l].
+*/
+template <int Window = 10, int DiffWindow = Window / 2>
+struct InterPosBatch {
+	static const int capacity = StreamStats<Window, DiffWindow>::capacity;
+	static const int typeCount = 16;
+
+	WindowSize<Window> window;
+	WindowSize<DiffWindow> diffWindow;
+
+	int laneCount = 0;
+
+	// thresholds, see KlassParams. float like pos, a double threshold would turn every lane into a double
+	int typePercent = 80;
+	float turnPos = 0.5f;
+	float turnHysteresis = 0.1f;
+	float laneChangeDif = 0.03f;
+	int entryFrames = 2;
+	int exitFrames = 3;
+	int minHoldFrames = 10;
+
+	// shared by all lanes
+	int head = 0;
+	int count = 0;
+	int typeHead = 0;
+	int typeFill = 0;
+	int size = 0;
+
+	// per lane, [slot * laneCount + lane]
+	float *samples = NULL;
+	int32_t *types = NULL;
+
+	// per lane, [lane * typeCount + type]
+	int32_t *counts = NULL;
+
+	// per lane, [lane]
+	double *sum = NULL;
+
+	// current state of every lane, same meaning as in InterPosList
+	float *pos = NULL;
+	float *posDifAvg = NULL;
+	int32_t *type = NULL;
+	int32_t *blink = NULL;
+
+	// hysteresis of every lane, see KlassHold
+	int32_t *decided = NULL;
+	int32_t *blinkState = NULL;
+	int32_t *candidate = NULL;
+	int32_t *candidateFrames = NULL;
+	int32_t *holdFrames = NULL;
+	int32_t *decisionFrames = NULL;
+
+	// resets the batch for 'lanes' streams with the default thresholds, the window sizes only change for DYNAMIC_WINDOW
+	void init(int lanes, int newWindow = Window? Window : 10, int newDiffWindow = DiffWindow? DiffWindow : 5) {
+		KlassParams params;
+		params.window = newWindow;
+		params.diffWindow = newDiffWindow;
+
+		init(lanes, params);
+	}
+
+	// resets the batch for 'lanes' streams, the window sizes in params only apply to DYNAMIC_WINDOW
+	void init(int lanes, const KlassParams &params) {
+		window.set(params.window, capacity);
+		diffWindow.set(params.diffWindow, capacity - 1);
+
+		typePercent = params.typePercent;
+		turnPos = (float)params.turnPos;
+		turnHysteresis = (float)params.turnHysteresis;
+		laneChangeDif = (float)params.laneChangeDif;
+		entryFrames = params.entryFrames;
+		exitFrames = params.exitFrames;
+		minHoldFrames = params.minHoldFrames;
+
+		laneCount = lanes;
+		head = 0;
+		count = 0;
+		typeHead = 0;
+		typeFill = 0;
+		size = 0;
+
+		samples = (float *)realloc(samples, capacity * lanes * sizeof *samples);
+		types = (int32_t *)realloc(types, capacity * lanes * sizeof *types);
+		counts = (int32_t *)realloc(counts, typeCount * lanes * sizeof *counts);
+		sum = (double *)realloc(sum, lanes * sizeof *sum);
+		pos = (float *)realloc(pos, lanes * sizeof *pos);
+		posDifAvg = (float *)realloc(posDifAvg, lanes * sizeof *posDifAvg);
+		type = (int32_t *)realloc(type, lanes * sizeof *type);
+		blink = (int32_t *)realloc(blink, lanes * sizeof *blink);
+		decided = (int32_t *)realloc(decided, lanes * sizeof *decided);
+		blinkState = (int32_t *)realloc(blinkState, lanes * sizeof *blinkState);
+		candidate = (int32_t *)realloc(candidate, lanes * sizeof *candidate);
+		candidateFrames = (int32_t *)realloc(candidateFrames, lanes * sizeof *candidateFrames);
+		holdFrames = (int32_t *)realloc(holdFrames, lanes * sizeof *holdFrames);
+		decisionFrames = (int32_t *)realloc(decisionFrames, lanes * sizeof *decisionFrames);
+
+		memset(samples, 0, capacity * lanes * sizeof *samples);
+		memset(types, 0, capacity * lanes * sizeof *types);
+		memset(counts, 0, typeCount * lanes * sizeof *counts);
+		memset(sum, 0, lanes * sizeof *sum);
+		memset(pos, 0, lanes * sizeof *pos);
+		memset(posDifAvg, 0, lanes * sizeof *posDifAvg);
+		memset(type, 0, lanes * sizeof *type);
+		memset(blink, 0, lanes * sizeof *blink);
+		memset(decided, 0, lanes * sizeof *decided);
+		memset(blinkState, 0, lanes * sizeof *blinkState);
+		memset(candidate, 0, lanes * sizeof *candidate);
+		memset(candidateFrames, 0, lanes * sizeof *candidateFrames);
+		memset(decisionFrames, 0, lanes * sizeof *decisionFrames);
+
+		for (int l = 0; l < lanes; ++l) holdFrames[l] = minHoldFrames;
+	}
+
+	void destroy() {
+		free(samples);
+		free(types);
+		free(counts);
+		free(sum);
+		free(pos);
+		free(posDifAvg);
+		free(type);
+		free(blink);
+		free(decided);
+		free(blinkState);
+		free(candidate);
+		free(candidateFrames);
+		free(holdFrames);
+		free(decisionFrames);
+
+		*this = InterPosBatch();
+	}
+
+	// push() and analyze() for one sample of every lane
+	void step(const int32_t *__restrict typeIn, const float *__restrict posIn) {
+		const int lanes = laneCount;
+		const int w = window.get();
+
+		/* Pos window */
+		{
+			float *__restrict newest = samples + head * lanes;
+			const float *__restrict oldest = samples + ((head - w + capacity) % capacity) * lanes;
+			double *__restrict s = sum;
+
+			// the oldest slot is 0 while the window is not full, like in StreamStats
+			for (int l = 0; l < lanes; ++l) {
+				float x = posIn[l];
+				s[l] += x - oldest[l];
+				newest[l] = x;
+			}
+
+			head = (head + 1) % capacity;
+			count += count < capacity;
+		}
+
+		/* Type window */
+		{
+			int full = typeFill >= w;
+
+			int32_t *__restrict newest = types + typeHead * lanes;
+			const int32_t *__restrict oldest = types + ((typeHead - w + capacity) % capacity) * lanes;
+
+			// a scatter, every lane only touches its own counts
+			for (int l = 0; l < lanes; ++l) {
+				int32_t *c = counts + l * typeCount;
+				int t = typeIn[l] & (typeCount - 1);
+
+				c[oldest[l]] -= full;
+				c[t]++;
+				newest[l] = t;
+			}
+
+			typeHead = (typeHead + 1) % capacity;
+			typeFill += typeFill < capacity;
+		}
+
+		if (size < w) size++;
+
+		/* Statistics and decision */
+		{
+			int n = count < w? count : w;
+			int span = count - 1 < diffWindow.get()? count - 1 : diffWindow.get();
+			int spanDiv = span > 0? span : 1;	// with no span 'first' is 'last' and the derivative is 0
+			int threshold = w * typePercent / 100;
+			bool isFull = size == w;
+
+			const float *__restrict last = samples + ((head - 1 + capacity) % capacity) * lanes;
+			const float *__restrict first = samples + ((head - 1 - span + capacity) % capacity) * lanes;
+
+			// the lane arrays never overlap, without saying so the compiler only vectorizes behind alias checks
+			const int32_t *__restrict c = counts;
+			const double *__restrict s = sum;
+			float *__restrict p = pos;
+			float *__restrict d = posDifAvg;
+			int32_t *__restrict ty = type;
+			int32_t *__restrict b = blink;
+			int32_t *__restrict out = decided;
+
+			// the count of the incoming type, a gather
+			for (int l = 0; l < lanes; ++l) {
+				int hits = c[l * typeCount + (typeIn[l] & (typeCount - 1))];
+
+				ty[l] = hits > threshold? typeIn[l] : ty[l];
+			}
+
+			for (int l = 0; l < lanes; ++l) {
+				p[l] = (float)(s[l] / n);
+				d[l] = (last[l] - first[l]) / spanDiv;
+			}
+
+			const float turn = turnPos;
+			const float turnBack = turnHysteresis;
+			const float laneDif = laneChangeDif;
+			const int entry = entryFrames;
+			const int exit = exitFrames;
+			const int hold = minHoldFrames;
+
+			// two loops, gcc does not vectorize the float and int work of both in one
+			for (int l = 0; l < lanes; ++l) {
+				out[l] = KlassDecide(ty[l], p[l], d[l], b[l], isFull, turn, laneDif, turnBack);
+			}
+
+			// the state machine stays scalar, it is a small part of the step
+			for (int l = 0; l < lanes; ++l) {
+				KlassHold(decided[l], blinkState[l], blink[l], candidate[l], candidateFrames[l], holdFrames[l],
+						  decisionFrames[l], entry, exit, hold);
+			}
+		}
+	}
+
+	// classifies 'steps' samples of every lane, the blink of sample t of lane l goes to blinkOut[t * laneCount + l]
+	void run(const int32_t *typeIn, const float *posIn, int steps, int8_t *blinkOut) {
+		for (int t = 0; t < steps; ++t) {
+			step(typeIn + t * laneCount, posIn + t * laneCount);
+
+			for (int l = 0; l < laneCount; ++l) {
+				blinkOut[t * laneCount + l] = blink[l];
+			}
+		}
+	}
+};
+
+typedef InterPosBatch<DYNAMIC_WINDOW, DYNAMIC_WINDOW> InterPosBatchDynamic;
@@ -0,0 +1,355 @@
+#pragma once
+
+// ============================================ STREAMING STATISTICS ============================================== //
+
+/* Window sizes are template parameters so the production configuration is fixed at compile time and the ring
+*  indexing and divisions fold into constants. DYNAMIC_WINDOW keeps the size at runtime instead, for tuning, with
+*  the same implementation on top.
+*/
+static const int DYNAMIC_WINDOW = 0;
+static const int DYNAMIC_CAPACITY = 64;
+
+template <int N>
+struct WindowSize {
+	int get() const { return N; }
+	void set(int, int) {}
+};
+
+// a size set at runtime is kept within 1 and 'max', what the ring of its user holds
+template <>
+struct WindowSize<DYNAMIC_WINDOW> {
+	int n = 1;
+
+	int get() const { return n; }
+	void set(int newN, int max) { n = newN < 1? 1 : newN > max? max : newN; }
+};
+
+/* Running statistics over a sliding window of samples.
+*  Every push is O(1): the window sums are updated with the sample that enters and the one that leaves,
+*  instead of summing the whole window again.
+*/
+template <int Window, int DiffWindow>
+struct StreamStats {
+	// enough samples for the window and for the derivative span
+	static const int capacity = (Window == DYNAMIC_WINDOW || DiffWindow == DYNAMIC_WINDOW)? DYNAMIC_CAPACITY :
+		(Window > DiffWindow? Window : DiffWindow + 1);
+
+	WindowSize<Window> window;			// samples in the mean and variance, at most capacity
+	WindowSize<DiffWindow> diffWindow;	// samples spanned by the derivative, below capacity
+	float alpha = 0.2f;					// ema smoothing factor
+
+	// last 'capacity' samples, slots that were never written stay 0 which the window sum relies on
+	float samples[capacity] = {};
+	int head = 0;
+	int count = 0;
+
+	// double so that adding and removing samples for hours does not drift
+	double sum = 0;
+	double sumSq = 0;
+
+	float ema = 0;
+
+	// the sizes only change for DYNAMIC_WINDOW, clamped to what the ring holds
+	void init(int newWindow, int newDiffWindow, float newAlpha) {
+		*this = StreamStats();
+
+		window.set(newWindow, capacity);
+		diffWindow.set(newDiffWindow, capacity - 1);
+		alpha = newAlpha;
+	}
+
+	void push(float x) {
+		// the sample leaving the window, 0 while the window is not full yet
+		float old = samples[(head - window.get() + capacity) % capacity];
+
+		sum += x - old;
+		sumSq += (double)x * x - (double)old * old;
+
+		ema = count? ema + alpha * (x - ema) : x;
+
+		samples[head] = x;
+		head = (head + 1) % capacity;
+		count += count < capacity;
+	}
+
+	int size() const {
+		return count < window.get()? count : window.get();
+	}
+
+	float last(int age = 0) const {
+		return samples[(head - 1 - age + capacity) % capacity];
+	}
+
+	float mean() const {
+		return count? (float)(sum / size()) : 0;
+	}
+
+	float variance() const {
+		if (!count) return 0;
+
+		double m = sum / size();
+		double v = sumSq / size() - m * m;
+
+		return v > 0? (float)v : 0;
+	}
+
+	// average change per sample over the last 'diffWindow' samples, the sum of the differences telescopes to
+	// newest - oldest
+	float derivative() const {
+		int span = count - 1 < diffWindow.get()? count - 1 : diffWindow.get();
+
+		return span > 0? (last() - last(span)) / span : 0;
+	}
+};
+
+/* Counts of the types in a sliding window, updated incrementally on every push.
+*/
+template <int Window>
+struct TypeCounts {
+	static const int capacity = (Window == DYNAMIC_WINDOW)? DYNAMIC_CAPACITY : Window;
+	static const int typeCount = 16;	// RoadState uses 4 bits
+
+	WindowSize<Window> window;
+
+	uint8_t types[capacity] = {};
+	int head = 0;
+	int count = 0;
+
+	int counts[typeCount] = {};
+	int modeType = 0;
+
+	// the size only changes for DYNAMIC_WINDOW, clamped to what the ring holds
+	void init(int newWindow) {
+		*this = TypeCounts();
+
+		window.set(newWindow, capacity);
+	}
+
+	void push(int type) {
+		type &= typeCount - 1;
+
+		// remove the type leaving the window, if the window is full
+		int old = types[(head - window.get() + capacity) % capacity];
+		int full = count >= window.get();
+
+		counts[old] -= full;
+		counts[type]++;
+
+		types[head] = type;
+		head = (head + 1) % capacity;
+		count += count < capacity;
+
+		// the mode only changes to the new type when it grows, or away from the old type when it shrinks
+		if (counts[type] > counts[modeType]) modeType = type;
+
+		if (full && old == modeType) {
+			for (int t = 0; t < typeCount; ++t) {
+				if (counts[t] > counts[modeType]) modeType = t;
+			}
+		}
+	}
+
+	int get(int type) const {
+		return counts[type & (typeCount - 1)];
+	}
+
+	int mode() const {
+		return modeType;
+	}
+};
+
+/* Running statistics over the samples of the last 'windowMs' milliseconds, for streams with a variable frame rate.
+*  Every sample carries a monotonic timestamp. The samples sit in a ring ordered by time, the window is the newest
+*  part of it and expiring is moving the end of the window forward, so each sample enters and leaves the sums once
+*  and a push is O(1) amortized however the frame times vary.
+*
+*  A sample is in the window while it is younger than windowMs, the derivative spans the samples at most diffWindowMs
+*  old. At a steady frame time this gives the same samples as StreamStats with windows of windowMs / frame time.
+*  The ring holds Capacity samples, at more than that per window the oldest ones are dropped early.
+*/
+template <int Capacity = 128>
+struct TimedStats {
+	static const int capacity = Capacity;
+
+	uint32_t windowMs = 330;
+	uint32_t diffWindowMs = 165;
+
+	float samples[Capacity] = {};
+	uint32_t times[Capacity] = {};
+	int head = 0;			// slot of the next sample
+	int windowCount = 0;	// newest samples in the window
+	int diffCount = 0;		// newest samples spanned by the derivative
+
+	double sum = 0;
+	double sumSq = 0;
+
+	void init(uint32_t newWindowMs, uint32_t newDiffWindowMs) {
+		*this = TimedStats();
+
+		windowMs = newWindowMs;
+		diffWindowMs = newDiffWindowMs;
+	}
+
+	int slot(int age) const {
+		return (head - 1 - age + Capacity) % Capacity;
+	}
+
+	void push(uint32_t time, float x) {
+		// a full ring drops its oldest sample whatever its age
+		if (windowCount == Capacity) expire();
+		if (diffCount == Capacity) diffCount--;
+
+		samples[head] = x;
+		times[head] = time;
+		head = (head + 1) % Capacity;
+
+		windowCount++;
+		diffCount++;
+
+		sum += x;
+		sumSq += (double)x * x;
+
+		// unsigned differences, so this keeps working when the millisecond clock wraps
+		while (windowCount > 1 && time - times[slot(windowCount - 1)] >= windowMs) expire();
+		while (diffCount > 1 && time - times[slot(diffCount - 1)] > diffWindowMs) diffCount--;
+	}
+
+	// removes the oldest sample of the window
+	void expire() {
+		float old = samples[slot(windowCount - 1)];
+
+		sum -= old;
+		sumSq -= (double)old * old;
+		windowCount--;
+	}
+
+	int size() const {
+		return windowCount;
+	}
+
+	float last(int age = 0) const {
+		return samples[slot(age)];
+	}
+
+	float mean() const {
+		return windowCount? (float)(sum / windowCount) : 0;
+	}
+
+	float variance() const {
+		if (!windowCount) return 0;
+
+		double m = sum / windowCount;
+		double v = sumSq / windowCount - m * m;
+
+		return v > 0? (float)v : 0;
+	}
+
+	// average change per millisecond over the last diffWindowMs
+	float derivative() const {
+		int span = diffCount - 1;
+		if (span <= 0) return 0;
+
+		uint32_t dt = times[slot(0)] - times[slot(span)];
+
+		return dt? (last() - last(span)) / dt : 0;
+	}
+};
+
+/* Counts of the types of the last 'windowMs' milliseconds, see TimedStats.
+*/
+template <int Capacity = 128>
+struct TimedTypeCounts {
+	static const int typeCount = 16;	// RoadState uses 4 bits
+
+	uint32_t windowMs = 330;
+
+	uint8_t types[Capacity] = {};
+	uint32_t times[Capacity] = {};
+	int head = 0;
+	int windowCount = 0;
+
+	int counts[typeCount] = {};
+
+	void init(uint32_t newWindowMs) {
+		*this = TimedTypeCounts();
+
+		windowMs = newWindowMs;
+	}
+
+	int slot(int age) const {
+		return (head - 1 - age + Capacity) % Capacity;
+	}
+
+	void push(uint32_t time, int type) {
+		type &= typeCount - 1;
+
+		if (windowCount == Capacity) counts[types[slot(--windowCount)]]--;
+
+		types[head] = type;
+		times[head] = time;
+		head = (head + 1) % Capacity;
+
+		windowCount++;
+		counts[type]++;
+
+		while (windowCount > 1 && time - times[slot(windowCount - 1)] >= windowMs) {
+			counts[types[slot(--windowCount)]]--;
+		}
+	}
+
+	int size() const {
+		return windowCount;
+	}
+
+	int get(int type) const {
+		return counts[type & (typeCount - 1)];
+	}
+};
+
+/* Counts of values in bins of binWidth, for latency and jitter percentiles. Values beyond the last bin count into it,
+*  max keeps the largest one exactly.
+*/
+struct Histogram {
+	static const int binCount = 256;
+
+	uint32_t binWidth = 1;
+	uint32_t bins[binCount] = {};
+	uint32_t count = 0;
+	uint32_t max = 0;
+
+	void init(uint32_t newBinWidth) {
+		*this = Histogram();
+
+		binWidth = newBinWidth;
+	}
+
+	void add(uint32_t value) {
+		uint32_t bin = value / binWidth;
+
+		bins[bin < binCount? bin : binCount - 1]++;
+		count++;
+
+		if (value > max) max = value;
+	}
+
+	// the value 'percent' of all values are at or below, to the upper edge of its bin
+	uint32_t percentile(float percent) const {
+		if (!count) return 0;
+
+		uint32_t rank = (uint32_t)ceilf(count * percent / 100.0f);
+		uint32_t seen = 0;
+
+		if (rank < 1) rank = 1;
+
+		for (int bin = 0; bin < binCount - 1; ++bin) {
+			seen += bins[bin];
+
+			if (seen >= rank) {
+				uint32_t edge = (bin + 1) * binWidth;
+				return edge < max? edge : max;
+			}
+		}
+
+		return max;
+	}
+};
@@ -3,42 +3,466 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
 
 #include <net/if.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <thread>
 
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/can/bcm.h>
+
+// the interface of the car, set it up with can_start.txt. a dev machine uses vcan0 instead, see test/can test
+#define CAN_INTERFACE   ("can0")
 
 struct Can {
 	int 		    socket;
 	sockaddr_can	addr;
 	can_frame	    frame;
 	ifreq 		    ifr;
+
+	uint32_t		sent;			// frames written
+	uint32_t		failed;			// frames the kernel did not take, mostly ENOBUFS when the tx queue is full
+	int				last_error;		// errno of the last failed call, 0 when there was none
 };
 
-static void canInit(Can *can) {
+// prints a failed call once for every change of errno, a dropped frame every millisecond would flood the console
+static void canReport(const char *name, int *last_error, const char *what) {
+	if (errno != *last_error) {
+		printf("can %s: %s failed: %s\n", name, what, strerror(errno));
+	}
+
+	*last_error = errno;
+}
+
+static void canReport(Can *can, const char *what) {
+	canReport(can->ifr.ifr_name, &can->last_error, what);
+}
+
+// opens a raw socket on the interface 'name' for sending, false when that failed and was reported
+static bool canInit(Can *can, const char *name = CAN_INTERFACE) {
 	memset(can, 0, sizeof (Can));
 
+	snprintf(can->ifr.ifr_name, sizeof can->ifr.ifr_name, "%s", name);
+
 	can->socket 		    = socket(PF_CAN, SOCK_RAW, CAN_RAW);
 	can->addr.can_family 	= AF_CAN;
 
-	strcpy(can->ifr.ifr_name, "can0");
-	ioctl(can->socket, SIOCGIFINDEX, &can->ifr);
+	if (can->socket < 0) {
+		canReport(can, "socket");
+		return false;
+	}
+
+	if (ioctl(can->socket, SIOCGIFINDEX, &can->ifr) < 0) {
+		canReport(can, "SIOCGIFINDEX");
+		goto fail;
+	}
 
 	can->addr.can_ifindex	= can->ifr.ifr_ifindex;
 
-	setsockopt(can->socket, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+	// nothing is received on this socket
+	if (setsockopt(can->socket, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0) < 0) {
+		canReport(can, "CAN_RAW_FILTER");
+		goto fail;
+	}
+
+	if (bind(can->socket, (struct sockaddr *)&can->addr, sizeof(can->addr)) < 0) {
+		canReport(can, "bind");
+		goto fail;
+	}
+
+	return true;
+
+fail:
+	close(can->socket);
+	can->socket = -1;
 
-	bind(can->socket, (struct sockaddr *)&can->addr, sizeof(can->addr));
+	return false;
 }
 
-static void canSend(Can *can, unsigned id, void *data, size_t data_size) {
+static void canDeinit(Can *can) {
+	if (can->socket >= 0) close(can->socket);
+
+	can->socket = -1;
+}
+
+// writes one frame, at most 8 bytes of data. false when it was not sent, the error is counted and reported
+static bool canSend(Can *can, unsigned id, const void *data, size_t data_size) {
+	if (data_size > 8) data_size = 8;
+
 	can->frame.can_id	= id;
-	can->frame.can_dlc 	= data_size > 8? 8 : data_size;
+	can->frame.can_dlc 	= data_size;
 
 	memcpy(can->frame.data, data, data_size);
 
-	write(can->socket, &can->frame, sizeof(can->frame));
+	ssize_t n = write(can->socket, &can->frame, sizeof(can->frame));
+
+	if (n != sizeof(can->frame)) {
+		if (n >= 0) errno = EIO;
+
+		canReport(can, "write");
+		can->failed++;
+
+		return false;
+	}
+
+	can->sent++;
+
+	return true;
 }
 
+// ============================================ CYCLIC TRANSMISSION ============================================ //
+
+/* One frame the kernel sends every 'period' through the broadcast manager (CAN_BCM), instead of a write for every
+*  command. The timing comes from a kernel timer, so it has no jitter from this process being scheduled and costs no
+*  wakeups. canCyclicUpdate only replaces the data, the changed frame goes out right away and the period continues.
+*
+*  The job belongs to the socket: when the process exits the kernel stops sending. While the process runs the last
+*  data keeps going out, whoever updates it has to keep its own dead man logic, see ControllerThread.
+*/
+struct CanCyclic {
+	int				socket;
+	char			name[IFNAMSIZ];
+
+	uint32_t		period_us;
+	can_frame		frame;
+
+	uint32_t		updates;		// changes of the data, repeating the same data is not one
+	uint32_t		failed;
+	int				last_error;
+};
+
+// one message to the broadcast manager, the header with a single frame after it
+static bool canCyclicWrite(CanCyclic *cc, uint32_t opcode, uint32_t flags, const char *what) {
+	struct {
+		uint8_t		head[sizeof (bcm_msg_head)];
+		can_frame	frame;
+	} msg;
+
+	bcm_msg_head head = {0};
+
+	head.opcode			= opcode;
+	head.flags			= flags;
+	head.can_id			= cc->frame.can_id;
+	head.nframes		= opcode == TX_DELETE? 0 : 1;
+	head.ival2.tv_sec	= cc->period_us / 1000000;
+	head.ival2.tv_usec	= cc->period_us % 1000000;
+
+	memcpy(msg.head, &head, sizeof head);
+	msg.frame = cc->frame;
+
+	size_t size = sizeof msg.head + head.nframes * sizeof msg.frame;
+
+	if (write(cc->socket, &msg, size) != (ssize_t)size) {
+		canReport(cc->name, &cc->last_error, what);
+		cc->failed++;
+
+		return false;
+	}
+
+	return true;
+}
+
+// starts sending frame 'id' with 'data' every 'period_us' on the interface 'name', false when that failed
+static bool canCyclicInit(CanCyclic *cc, const char *name, unsigned id, const void *data, size_t data_size,
+						  uint32_t period_us) {
+	memset(cc, 0, sizeof (CanCyclic));
+
+	snprintf(cc->name, sizeof cc->name, "%s", name);
+
+	cc->socket = socket(PF_CAN, SOCK_DGRAM, CAN_BCM);
+
+	if (cc->socket < 0) {
+		canReport(cc->name, &cc->last_error, "socket");
+		return false;
+	}
+
+	sockaddr_can addr = {0};
+
+	addr.can_family		= AF_CAN;
+	addr.can_ifindex	= if_nametoindex(name);
+
+	if (!addr.can_ifindex) {
+		canReport(cc->name, &cc->last_error, "if_nametoindex");
+		goto fail;
+	}
+
+	if (connect(cc->socket, (struct sockaddr *)&addr, sizeof addr) < 0) {
+		canReport(cc->name, &cc->last_error, "connect");
+		goto fail;
+	}
+
+	if (data_size > 8) data_size = 8;
+
+	cc->period_us		= period_us;
+	cc->frame.can_id	= id;
+	cc->frame.can_dlc	= data_size;
+
+	memcpy(cc->frame.data, data, data_size);
+
+	// the first frame right away, then every ival2
+	if (!canCyclicWrite(cc, TX_SETUP, SETTIMER | STARTTIMER | TX_ANNOUNCE, "TX_SETUP")) goto fail;
+
+	return true;
+
+fail:
+	close(cc->socket);
+	cc->socket = -1;
+
+	return false;
+}
+
+// replaces the data of the cyclic frame, it is sent once right away and then with the running period. the same data
+// again changes nothing, so repeated commands do not add frames to the bus or shift the period
+static bool canCyclicUpdate(CanCyclic *cc, const void *data, size_t data_size) {
+	if (data_size > 8) data_size = 8;
+
+	if (cc->frame.can_dlc == data_size && memcmp(cc->frame.data, data, data_size) == 0) return true;
+
+	cc->frame.can_dlc = data_size;
+	memcpy(cc->frame.data, data, data_size);
+
+	if (!canCyclicWrite(cc, TX_SETUP, TX_ANNOUNCE, "TX_SETUP update")) return false;
+
+	cc->updates++;
+
+	return true;
+}
+
+// stops sending and closes the socket
+static void canCyclicDeinit(CanCyclic *cc) {
+	if (cc->socket < 0) return;
+
+	canCyclicWrite(cc, TX_DELETE, 0, "TX_DELETE");
+
+	close(cc->socket);
+	cc->socket = -1;
+}
+
+// ================================================= RECEIVING ================================================= //
+
+/* Frames from the bus, read by a thread of their own and handed to the control loop through a ring buffer. The loop
+*  polls the ring and never blocks on the socket, the thread never waits for the loop. A full ring drops the newest
+*  frame and counts it, the loop was not polling anyway.
+*/
+
+// frames the ring holds, a power of two. 1024 frames are a quarter second of a full 500 kbit/s bus
+#define CAN_RING_SIZE       (1024)
+
+// the receive thread checks this often whether it should stop, in ms
+#define CAN_RECV_TIMEOUT_MS (100)
+
+struct CanFrame {
+	can_frame		frame;
+	uint64_t		time_ns;		// when the kernel received it, CLOCK_REALTIME from SO_TIMESTAMPNS
+};
+
+// one producer, one consumer. each side only writes its own cache line, the counter can be read from any thread
+struct CanRing {
+	CanFrame						frames[CAN_RING_SIZE];
+
+	// written by the producer
+	alignas(64) std::atomic<uint32_t>	head;
+	std::atomic<uint32_t>				dropped;
+
+	// written by the consumer
+	alignas(64) std::atomic<uint32_t>	tail;
+};
+
+static bool canRingPush(CanRing *ring, const CanFrame *f) {
+	uint32_t head = ring->head.load(std::memory_order_relaxed);
+
+	if (head - ring->tail.load(std::memory_order_acquire) == CAN_RING_SIZE) {
+		ring->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	ring->frames[head & (CAN_RING_SIZE - 1)] = *f;
+	ring->head.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+// the oldest frame, false when there is none
+static bool canRingPop(CanRing *ring, CanFrame *f) {
+	uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+
+	if (tail == ring->head.load(std::memory_order_acquire)) return false;
+
+	*f = ring->frames[tail & (CAN_RING_SIZE - 1)];
+	ring->tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+struct CanReceiver {
+	int					socket;
+	char				name[IFNAMSIZ];
+
+	std::thread			thread;
+	std::atomic<bool>	running;
+
+	CanRing				ring;
+
+	std::atomic<uint32_t>	received;	// frames read from the socket, written by the thread
+	int					last_error;
+};
+
+static void canReceiverThread(CanReceiver *rx) {
+	CanFrame	f;
+	char		control[CMSG_SPACE(sizeof (timespec))];
+
+	while (rx->running.load(std::memory_order_relaxed)) {
+		iovec	iov = { &f.frame, sizeof f.frame };
+		msghdr	msg = {0};
+
+		msg.msg_iov			= &iov;
+		msg.msg_iovlen		= 1;
+		msg.msg_control		= control;
+		msg.msg_controllen	= sizeof control;
+
+		ssize_t n = recvmsg(rx->socket, &msg, 0);
+
+		if (n != sizeof f.frame) {
+			if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				canReport(rx->name, &rx->last_error, "recvmsg");
+			}
+
+			continue;
+		}
+
+		f.time_ns = 0;
+
+		for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+			if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_TIMESTAMPNS) {
+				timespec ts;
+				memcpy(&ts, CMSG_DATA(c), sizeof ts);
+
+				f.time_ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+			}
+		}
+
+		rx->received.fetch_add(1, std::memory_order_relaxed);
+
+		canRingPush(&rx->ring, &f);
+	}
+}
+
+/* Starts receiving on the interface 'name', false when that failed and was reported. Only frames that pass one of
+*  the 'filters' are received, a frame passes when (frame id & can_mask) == (can_id & can_mask). Without filters
+*  every frame is received, the frames other sockets of this process send too, the interface loops them back.
+*/
+static bool canReceiverStart(CanReceiver *rx, const char *name, const can_filter *filters = NULL,
+							 int filter_count = 0) {
+	snprintf(rx->name, sizeof rx->name, "%s", name);
+
+	rx->last_error = 0;
+
+	rx->received.store(0);
+	rx->ring.dropped.store(0);
+	rx->ring.head.store(0);
+	rx->ring.tail.store(0);
+
+	rx->socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+	if (rx->socket < 0) {
+		canReport(rx->name, &rx->last_error, "socket");
+		return false;
+	}
+
+	sockaddr_can	addr		= {0};
+	int				on			= 1;
+	timeval			timeout		= { 0, CAN_RECV_TIMEOUT_MS * 1000 };
+
+	addr.can_family		= AF_CAN;
+	addr.can_ifindex	= if_nametoindex(name);
+
+	if (!addr.can_ifindex) {
+		canReport(rx->name, &rx->last_error, "if_nametoindex");
+		goto fail;
+	}
+
+	if (filters && setsockopt(rx->socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters,
+							  filter_count * sizeof (can_filter)) < 0) {
+		canReport(rx->name, &rx->last_error, "CAN_RAW_FILTER");
+		goto fail;
+	}
+
+	if (setsockopt(rx->socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on) < 0) {
+		canReport(rx->name, &rx->last_error, "SO_TIMESTAMPNS");
+		goto fail;
+	}
+
+	if (setsockopt(rx->socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) < 0) {
+		canReport(rx->name, &rx->last_error, "SO_RCVTIMEO");
+		goto fail;
+	}
+
+	if (bind(rx->socket, (struct sockaddr *)&addr, sizeof addr) < 0) {
+		canReport(rx->name, &rx->last_error, "bind");
+		goto fail;
+	}
+
+	rx->running = true;
+	rx->thread	= std::thread(canReceiverThread, rx);
+
+	return true;
+
+fail:
+	close(rx->socket);
+	rx->socket = -1;
+
+	return false;
+}
+
+/* Reads filters like "181:7FF,280:7F0" into 'filters', hex id and mask pairs separated by commas. The mask may be
+*  left out, then only that id passes. Returns the number read, -1 when the text is not like that or there are more
+*  than 'max'.
+*/
+static int canParseFilters(const char *text, can_filter *filters, int max) {
+	int count = 0;
+
+	while (*text) {
+		if (count == max) return -1;
+
+		char *end;
+
+		filters[count].can_id	= strtoul(text, &end, 16);
+		filters[count].can_mask	= CAN_SFF_MASK;
+
+		if (end == text) return -1;
+
+		text = end;
+
+		if (*text == ':') {
+			filters[count].can_mask = strtoul(text + 1, &end, 16);
+
+			if (end == text + 1) return -1;
+
+			text = end;
+		}
+
+		count++;
+
+		if (*text == ',') text++;
+		else if (*text) return -1;
+	}
+
+	return count;
+}
+
+// stops the thread within CAN_RECV_TIMEOUT_MS and closes the socket, what is left in the ring can still be read
+static void canReceiverStop(CanReceiver *rx) {
+	if (rx->thread.joinable()) {
+		rx->running = false;
+		rx->thread.join();
+	}
+
+	if (rx->socket >= 0) close(rx->socket);
+
+	rx->socket = -1;
+}
@@ -0,0 +1,448 @@
+#pragma once
+
+// the controller link of the car: receives ControllerPackages on UDP, writes them to CAN, stops the car when they stop
+// coming and sends the telemetry back. runs in its own thread, see ControllerThread.
+
+#include <mutex>
+#include <time.h>
+#include <signal.h>
+
+// the blinker decided by the main loop, sent with every controller frame
+static int          blink;
+
+static Controller   controller = {0};
+
+// where ControllerThread listens and writes to, the car uses the defaults. the CAN interface is the third command line
+// argument
+static int          controller_port             = 8888;
+static const char   *controller_can_interface   = CAN_INTERFACE;
+
+// with a period the kernel repeats the controller frame on its own and only a changed command updates it, see
+// CanCyclic. 0 writes one frame for every command. the fourth command line argument, in ms
+static int          controller_can_period_ms    = 0;
+
+// written by ControllerThread only, the main loop reads the counters for the status
+static Can          controller_can;
+static CanCyclic    controller_can_cyclic       = { -1 };
+
+// the frame of the motor controller, see Controller
+#define CONTROLLER_CAN_ID   (0x7DF)
+
+// what the MCUs send back, polled by ControllerThread. only the ids of controller_can_filters are received, set them
+// with the fifth command line argument, see canParseFilters. without filters every frame but our own is received
+#define CONTROLLER_CAN_FILTERS_MAX  (16)
+
+static can_filter   controller_can_filters[CONTROLLER_CAN_FILTERS_MAX];
+static int          controller_can_filter_count = 0;
+
+static CanReceiver  controller_can_rx;
+
+static void controllerCanSend(const Controller *c)
+{
+    if (controller_can_period_ms) {
+        canCyclicUpdate(&controller_can_cyclic, c, sizeof (Controller));
+    } else {
+        canSend(&controller_can, CONTROLLER_CAN_ID, c, sizeof (Controller));
+    }
+}
+
+// microseconds of a monotonic clock
+static uint64_t monotonicUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// milliseconds of a monotonic clock, for the classification windows
+static uint32_t monotonicMs(void)
+{
+    return (uint32_t)(monotonicUs() / 1000);
+}
+
+// without a valid package for this long the car stops, set with the first command line argument
+static int controller_timeout_ms = 250;
+
+// a failsafe frame that reaches CAN later than this after the deadline counts as late
+#define CONTROLLER_FAILSAFE_BOUND_US    (2000)
+
+// packages delayed this much more than the fastest ones are dropped as stale
+#define CONTROLLER_STALE_US             (100000)
+
+struct ControllerLink {
+    bool        lost;
+    uint32_t    lost_count;             // times the link was lost
+    uint32_t    received;               // valid packages
+    uint32_t    superseded;             // valid packages skipped because a newer one was waiting
+    uint32_t    rejected;               // wrong size, version or crc
+    uint32_t    out_of_order;           // not newer than the last accepted package, duplicates too
+    uint32_t    stale;                  // delayed more than CONTROLLER_STALE_US
+    uint32_t    failsafe_count;         // zero thrust frames sent
+    uint32_t    failsafe_late;          // of those, later than CONTROLLER_FAILSAFE_BOUND_US
+    uint32_t    failsafe_latency_us;    // deadline to the frame written to CAN, last and worst
+    uint32_t    failsafe_latency_max_us;
+
+    // the client clock is not synchronized with ours, so the delay of a package is measured against the fastest
+    // ones. all of this starts over when the link is lost, the client may have restarted
+    bool        synced;
+    uint32_t    last_sequence;
+    uint32_t    applied_sequence;       // of the last package sent to CAN
+    uint32_t    delay_base;             // receive minus send time of the fastest packages, follows clock drift
+    uint64_t    last_arrival_us;
+
+    Histogram   inter_arrival;          // us between accepted packages
+    Histogram   jitter;                 // us an accepted package was slower than the fastest ones
+
+    // where the last accepted package came from, the telemetry goes there
+    bool        has_peer;
+    sockaddr_in peer;
+
+    // the client in control, see ControllerPackage
+    bool        has_session;
+    uint32_t    session;
+    uint8_t     priority;
+    uint32_t    handovers;              // times another session took over
+    uint32_t    not_in_control;         // valid packages of sessions that do not control the car
+    uint32_t    releases;
+};
+
+static ControllerLink controller_link = {0};
+
+// toggled by SIGUSR1 (kill -USR1 <pid>), the main loop then prints the percentiles of the link with the status
+static volatile sig_atomic_t controller_report = 0;
+
+static void controllerReportSignal(int)
+{
+    controller_report = !controller_report;
+}
+
+static void controllerLinkReport(const ControllerLink *link)
+{
+    const Histogram *histograms[] = { &link->inter_arrival, &link->jitter };
+    const char      *names[]      = { "inter-arrival", "jitter" };
+
+    for (int i = 0; i < 2; ++i) {
+        const Histogram *h = histograms[i];
+
+        printf("%-14s n %u  p50 %u us  p90 %u us  p99 %u us  max %u us\n", names[i], h->count,
+               h->percentile(50), h->percentile(90), h->percentile(99), h->max);
+    }
+
+    printf("rejected %u, out of order %u, stale %u, superseded %u\n",
+           link->rejected, link->out_of_order, link->stale, link->superseded);
+    printf("session %08x (priority %u), %u handovers, %u releases, %u packages of other sessions\n",
+           link->has_session? link->session : 0, link->priority, link->handovers, link->releases, link->not_in_control);
+}
+
+// whether a valid package comes from the session in control, which may change to its session first. a release
+// ends the session and is not applied itself, 'released' is set so the caller stops the car
+static bool controllerArbitrate(ControllerLink *link, const ControllerPackage *cp, bool *released)
+{
+    bool same = link->has_session && cp->session == link->session;
+
+    if (!same) {
+        // a lost link is free, the client in control may be gone
+        bool free       = !link->has_session || link->lost;
+        bool preempts   = cp->priority > link->priority;
+
+        if (cp->session == 0 || (cp->flags & CONTROLLER_RELEASE) || (!free && !preempts)) {
+            link->not_in_control++;
+            return false;
+        }
+
+        if (link->has_session) link->handovers++;
+
+        link->has_session   = true;
+        link->session       = cp->session;
+        link->priority      = cp->priority;
+
+        // the sequence and the clock of the new client have nothing to do with the old ones
+        link->synced        = false;
+    }
+
+    if (cp->flags & CONTROLLER_RELEASE) {
+        link->has_session   = false;
+        link->priority      = 0;
+        link->releases++;
+
+        *released = true;
+        return false;
+    }
+
+    return true;
+}
+
+// sequence and delay checks of the newest valid package of a wakeup, true when it should be applied
+static bool controllerPackageAccept(ControllerLink *link, const ControllerPackage *cp, uint64_t now)
+{
+    if (link->synced && (int32_t)(cp->sequence - link->last_sequence) <= 0) {
+        link->out_of_order++;
+        return false;
+    }
+
+    // unsigned differences, both clocks wrap around
+    uint32_t delay = (uint32_t)now - cp->time_us;
+
+    if (!link->synced || (int32_t)(delay - link->delay_base) < 0) link->delay_base = delay;
+
+    uint32_t late = delay - link->delay_base;
+
+    link->last_sequence = cp->sequence;
+
+    if (link->synced && late > CONTROLLER_STALE_US) {
+        link->stale++;
+        return false;
+    }
+
+    // lets the base follow the clocks drifting apart, a single slow package barely moves it
+    link->delay_base += late / 256;
+
+    link->jitter.add(late);
+    if (link->synced) link->inter_arrival.add((uint32_t)(now - link->last_arrival_us));
+
+    link->last_arrival_us   = now;
+    link->synced            = true;
+
+    return true;
+}
+
+// the state of the car for the telemetry, written by the main loop and sent by ControllerThread
+static Telemetry    telemetry_state = {0};
+static std::mutex   telemetry_mutex;
+
+// the client address for the main loop, set by ControllerThread under telemetry_mutex
+static bool         client_has_peer = false;
+static sockaddr_in  client_peer     = {0};
+
+// what the main loop shows of the feedback, set by ControllerThread under telemetry_mutex
+static uint32_t     controller_can_feedback     = 0;    // frames taken from the ring
+static CanFrame     controller_can_last         = {0};
+
+// what the main loop shows of the link, copied by ControllerThread under telemetry_mutex after every wakeup
+static ControllerLink controller_link_shown = {0};
+
+// takes what arrived since the last call, never blocks
+static void controllerCanPoll(void)
+{
+    CanFrame    f;
+    CanFrame    last;
+    uint32_t    count = 0;
+
+    while (canRingPop(&controller_can_rx.ring, &f)) {
+        last = f;
+        count++;
+    }
+
+    if (!count) return;
+
+    std::lock_guard<std::mutex> lock(telemetry_mutex);
+
+    controller_can_last      = last;
+    controller_can_feedback += count;
+}
+
+static void telemetrySend(Server *server, ControllerLink *link, uint32_t sequence)
+{
+    Telemetry t;
+
+    {
+        std::lock_guard<std::mutex> lock(telemetry_mutex);
+        t = telemetry_state;
+    }
+
+    t.version       = TELEMETRY_VERSION;
+    t.flags         = link->lost? TELEMETRY_LINK_LOST : 0;
+    t.sequence      = sequence;
+    t.ack_sequence  = link->applied_sequence;
+    t.crc32         = TelemetryCode(&t);
+
+    netServerSend(server, &link->peer, &t, sizeof t);
+}
+
+static void ControllerThread(void)
+{
+	Server 		server      = {0};
+
+    // without CAN the link still runs, so the client sees the car, but nothing reaches the motors. the cyclic frame
+    // starts out stopped, until the first package arrives it is what the car gets
+    bool has_can;
+
+    if (controller_can_period_ms) {
+        has_can = canCyclicInit(&controller_can_cyclic, controller_can_interface, CONTROLLER_CAN_ID, &controller,
+                                sizeof (Controller), (uint32_t)controller_can_period_ms * 1000);
+    } else {
+        has_can = canInit(&controller_can, controller_can_interface);
+    }
+
+	if (!has_can) {
+        printf("no CAN on %s, controller commands are not sent\n", controller_can_interface);
+    }
+
+    // the controller frame comes back from the loopback of the interface
+    if (!controller_can_filter_count) {
+        controller_can_filters[0].can_id    = CONTROLLER_CAN_ID | CAN_INV_FILTER;
+        controller_can_filters[0].can_mask  = CAN_SFF_MASK;
+
+        controller_can_filter_count = 1;
+    }
+
+    canReceiverStart(&controller_can_rx, controller_can_interface, controller_can_filters,
+                     controller_can_filter_count);
+
+	netServerInit(&server, controller_port);
+
+    controller_link.inter_arrival.init(500);
+    controller_link.jitter.init(500);
+
+    const uint64_t timeout_us = (uint64_t)controller_timeout_ms * 1000;
+
+    // the deadline runs from the last valid package, so nothing applies longer than the timeout
+    uint64_t deadline = monotonicUs() + timeout_us;
+
+    const uint64_t  telemetry_period_us = 1000000 / TELEMETRY_RATE_HZ;
+    uint64_t        telemetry_next      = monotonicUs() + telemetry_period_us;
+    uint32_t        telemetry_sequence  = 0;
+
+	while (1) {
+        uint64_t now = monotonicUs();
+
+        // rounded up so poll does not wake up before the deadline
+        uint64_t wake = deadline < telemetry_next? deadline : telemetry_next;
+
+        int wait_ms = now < wake? (int)((wake - now + 999) / 1000) : 0;
+
+        if (netServerWait(&server, wait_ms) > 0) {
+            // drains everything that is waiting and applies only the newest valid package, so a burst does not
+            // turn into a queue of stale commands
+            ControllerPackage   packages[NET_RECV_BATCH];
+            int                 sizes[NET_RECV_BATCH];
+            sockaddr_in         addrs[NET_RECV_BATCH];
+
+            ControllerPackage   newest      = {0};
+            sockaddr_in         newest_addr = {0};
+            int                 valid       = 0;        // of the session in control
+            bool                released    = false;
+
+            while (1) {
+                int count = netServerRecvBatch(&server, packages, sizeof (ControllerPackage), NET_RECV_BATCH, sizes,
+                                               addrs);
+
+                for (int i = 0; i < count; ++i) {
+                    ControllerPackage *cp = &packages[i];
+
+                    if (!ControllerPackageValid(cp, sizes[i])) {
+                        controller_link.rejected++;
+                        continue;
+                    }
+
+                    controller_link.received++;
+
+                    if (!controllerArbitrate(&controller_link, cp, &released)) {
+                        if (!controller_link.has_session) {
+                            // released, nothing before it in this batch applies either
+                            controller_link.superseded += valid;
+                            valid = 0;
+                        }
+
+                        continue;
+                    }
+
+                    // a handover in the middle of the batch, what the old session sent before does not apply
+                    if (valid && cp->session != newest.session) {
+                        controller_link.superseded += valid;
+                        valid = 0;
+                    }
+
+                    // newest by sequence, the network may have reordered them
+                    if (!valid || (int32_t)(cp->sequence - newest.sequence) > 0) {
+                        newest      = *cp;
+                        newest_addr = addrs[i];
+                    }
+
+                    valid++;
+                }
+
+                if (count < NET_RECV_BATCH) break;
+            }
+
+            if (valid) controller_link.superseded += valid - 1;
+
+            // the client gave up control, stop now instead of at the deadline
+            if (released) deadline = monotonicUs();
+
+            if (valid && controllerPackageAccept(&controller_link, &newest, monotonicUs())) {
+                controller = newest.controller;
+
+                controller.blink = blink;
+
+                //printf("s %d\n", controller.steering);
+                //printf("b %d\n", controller.blink);
+
+                //puts("can send");
+                controllerCanSend(&controller);
+
+                deadline = monotonicUs() + timeout_us;
+                controller_link.lost                = false;
+                controller_link.applied_sequence    = newest.sequence;
+                controller_link.peer                = newest_addr;
+                controller_link.has_peer            = true;
+
+                {
+                    std::lock_guard<std::mutex> lock(telemetry_mutex);
+
+                    client_peer     = newest_addr;
+                    client_has_peer = true;
+                }
+            }
+        }
+
+        controllerCanPoll();
+
+        if (monotonicUs() >= telemetry_next) {
+            if (controller_link.has_peer) telemetrySend(&server, &controller_link, telemetry_sequence++);
+
+            telemetry_next += telemetry_period_us;
+
+            if (telemetry_next < monotonicUs()) telemetry_next = monotonicUs() + telemetry_period_us;
+        }
+
+        if (monotonicUs() >= deadline) {
+            // dead man: stop, keep the steering and the blinker. a cyclic frame keeps repeating the stop
+            controller.thrust   = 0;
+            controller.blink    = blink;
+
+            controllerCanSend(&controller);
+
+            uint32_t latency = (uint32_t)(monotonicUs() - deadline);
+
+            if (!controller_link.lost) controller_link.lost_count++;
+
+            controller_link.lost                = true;
+            controller_link.synced              = false;
+            controller_link.failsafe_count++;
+            controller_link.failsafe_late      += latency > CONTROLLER_FAILSAFE_BOUND_US;
+            controller_link.failsafe_latency_us = latency;
+
+            if (latency > controller_link.failsafe_latency_max_us) controller_link.failsafe_latency_max_us = latency;
+
+            // repeated every timeout while the link is down
+            deadline += timeout_us;
+
+            if (deadline < monotonicUs()) deadline = monotonicUs() + timeout_us;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(telemetry_mutex);
+
+            controller_link_shown = controller_link;
+        }
+    }
+}
+
+// stops the CAN receiver of ControllerThread. call it before returning from main: a static CanReceiver with a thread
+// that can still be joined calls std::terminate when it is destroyed
+static void controllerStop(void)
+{
+    canReceiverStop(&controller_can_rx);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// streams the tilemap and the edge image to the client instead of showing them in local windows, see DebugImageFragment.
+// everything sent is counted against a kbit/s budget, an image that does not fit what is left of it is dropped and
+// never queued, so the stream can not back up into the controller link or add latency to the next image.
+
+// bytes of IP and UDP header every fragment costs on top of its own size
+#define DEBUG_STREAM_OVERHEAD       (28)
+
+// the budget saved up while nothing is sent, in ms. an image larger than this much of the budget is never sent
+#define DEBUG_STREAM_BURST_MS       (250)
+
+struct DebugStream {
+    Server      server;                 // its own socket, bound to any port
+    int         kbps;                   // 0 turns the stream off
+    int         edge_scale;             // the edge image is downsampled by this much before it is encoded
+    int         edge_quality;           // JPEG quality of the edge image
+
+    double      budget;                 // bytes that may be sent now
+    double      budget_max;
+    uint64_t    last_us;
+
+    uint16_t    frame[DEBUG_IMAGE_KIND_COUNT];
+    uint32_t    sent[DEBUG_IMAGE_KIND_COUNT];
+    uint32_t    dropped[DEBUG_IMAGE_KIND_COUNT];
+    uint32_t    image_size[DEBUG_IMAGE_KIND_COUNT];     // encoded bytes of the last image, sent or not
+    uint64_t    sent_bytes;
+
+    std::vector<uint8_t>    tiles;
+    std::vector<uint8_t>    encoded;
+};
+
+static void debugStreamInit(DebugStream *stream, int kbps, uint64_t now_us)
+{
+    *stream = DebugStream();
+
+    netServerInit(&stream->server, 0);
+
+    stream->kbps            = kbps;
+    stream->edge_scale      = 2;
+    stream->edge_quality    = 30;
+
+    stream->budget_max      = (double)kbps * 1000 / 8 * DEBUG_STREAM_BURST_MS / 1000;
+    stream->budget          = stream->budget_max;
+    stream->last_us         = now_us;
+}
+
+// sends one encoded image in fragments, false when it was dropped for the budget
+static bool debugStreamImage(DebugStream *stream, const sockaddr_in *to, int kind, int width, int height,
+                             const uint8_t *data, int size, uint64_t now_us)
+{
+    stream->budget += (double)(now_us - stream->last_us) * stream->kbps / 8000;
+    stream->last_us = now_us;
+
+    if (stream->budget > stream->budget_max) stream->budget = stream->budget_max;
+
+    stream->image_size[kind] = size;
+
+    int count = (size + DEBUG_IMAGE_PAYLOAD - 1) / DEBUG_IMAGE_PAYLOAD;
+    if (count == 0) count = 1;
+
+    double cost = size + count * (double)(DEBUG_IMAGE_HEADER_SIZE + DEBUG_STREAM_OVERHEAD);
+
+    if (count > DEBUG_IMAGE_MAX_FRAGMENTS || cost > stream->budget) {
+        stream->dropped[kind]++;
+        return false;
+    }
+
+    stream->budget -= cost;
+
+    DebugImageFragment f;
+
+    f.version       = DEBUG_IMAGE_VERSION;
+    f.kind          = kind;
+    f.frame         = stream->frame[kind]++;
+    f.width         = width;
+    f.height        = height;
+    f.count         = count;
+    f.image_size    = size;
+
+    for (int i = 0; i < count; ++i) {
+        int offset = i * DEBUG_IMAGE_PAYLOAD;
+
+        f.index = i;
+        f.size  = CLAMP_MAX(size - offset, DEBUG_IMAGE_PAYLOAD);
+
+        memcpy(f.data, data + offset, f.size);
+        f.crc32 = DebugImageFragmentCode(&f);
+
+        netServerSend(&stream->server, to, &f, DEBUG_IMAGE_HEADER_SIZE + f.size);
+    }
+
+    stream->sent[kind]++;
+    stream->sent_bytes += (uint64_t)cost;
+
+    return true;
+}
+
+// encodes and sends the tilemap and the edge image of this frame. the tilemap goes first, it is the smaller one and
+// shows the most
+static void debugStreamFrame(DebugStream *stream, const sockaddr_in *to, const Tilemap *map, const cv::Mat &edge,
+                             uint64_t now_us)
+{
+    if (!stream->kbps) return;
+
+    const int capacity = DEBUG_IMAGE_MAX_FRAGMENTS * DEBUG_IMAGE_PAYLOAD;
+
+    {
+        int count = map->width * map->height;
+
+        stream->tiles.resize(count);
+        stream->encoded.resize(capacity);
+
+        for (int y = 0; y < map->height; ++y) {
+            for (int x = 0; x < map->width; ++x) {
+                stream->tiles[y * map->width + x] = TilemapGet(map, x, y);
+            }
+        }
+
+        int size = DebugTilemapEncode(stream->encoded.data(), capacity, stream->tiles.data(), count);
+
+        if (size >= 0) {
+            debugStreamImage(stream, to, DEBUG_IMAGE_TILEMAP, map->width, map->height, stream->encoded.data(), size,
+                             now_us);
+        } else {
+            stream->dropped[DEBUG_IMAGE_TILEMAP]++;
+        }
+    }
+
+    if (!edge.empty()) {
+        cv::Mat small;
+        cv::resize(edge, small, cv::Size(edge.cols / stream->edge_scale, edge.rows / stream->edge_scale), 0, 0,
+                   cv::INTER_AREA);
+
+        cv::imencode(".jpg", small, stream->encoded, { cv::IMWRITE_JPEG_QUALITY, stream->edge_quality });
+
+        debugStreamImage(stream, to, DEBUG_IMAGE_EDGE, small.cols, small.rows, stream->encoded.data(),
+                         (int)stream->encoded.size(), now_us);
+    }
+}
+
+static void debugStreamReport(const DebugStream *stream)
+{
+    printf("stream %d kbit/s, tilemap %u sent %u dropped (%u B), edge %u sent %u dropped (%u B)\n", stream->kbps,
+           stream->sent[DEBUG_IMAGE_TILEMAP], stream->dropped[DEBUG_IMAGE_TILEMAP], stream->image_size[DEBUG_IMAGE_TILEMAP],
+           stream->sent[DEBUG_IMAGE_EDGE], stream->dropped[DEBUG_IMAGE_EDGE], stream->image_size[DEBUG_IMAGE_EDGE]);
+}
@@ -7,52 +7,48 @@
 #include "net.h"
 
 #include "../controller/controller.c"
+#include "debug_stream.h"
+#include "controller_thread.h"
 
 #include <thread>
+#include <mutex>
+#include <time.h>
+#include <signal.h>
 
 #include <iostream>
 
 #define ARRAY_COUNT(array) (sizeof (array) / sizeof (array[0]))
 
 static float   pos;
-static int     blink;
 
-static Controller controller = {0};
+// kbit/s of the debug image stream, 0 shows local windows instead. set with the second command line argument
+static int debug_stream_kbps = 0;
 
-static void ControllerThread(void)
+int main(int argc, char **argv)
 {
-	Can 		can         = {0};
-	Server 		server      = {0};
-
-    //puts("can");
-	canInit(&can);
-    //puts("net");
-	netServerInit(&server, 8888);
+    if (argc > 1) controller_timeout_ms = atoi(argv[1]);
+    if (controller_timeout_ms < 1) controller_timeout_ms = 1;
 
-	while (1) {
-        //puts("net recv");
-        ControllerPackage cp = {0};
+    if (argc > 2) debug_stream_kbps = atoi(argv[2]);
+    if (debug_stream_kbps < 0) debug_stream_kbps = 0;
 
-		netServerRecv(&server, &cp, sizeof (ControllerPackage));
+    if (argc > 3) controller_can_interface = argv[3];
 
-        uint32_t code = CRC32Code(&cp.controller, sizeof (Controller));
+    if (argc > 4) controller_can_period_ms = atoi(argv[4]);
+    if (controller_can_period_ms < 0) controller_can_period_ms = 0;
 
-        if (cp.crc32 == code) {
-            controller = cp.controller;
+    if (argc > 5) {
+        controller_can_filter_count = canParseFilters(argv[5], controller_can_filters, CONTROLLER_CAN_FILTERS_MAX);
 
-            controller.blink = blink;
-
-            //printf("s %d\n", controller.steering);
-            //printf("b %d\n", controller.blink);
-
-            //puts("can send");
-            canSend(&can, 0x7DF, &controller, sizeof (Controller));
+        if (controller_can_filter_count < 0) {
+            printf("bad CAN filters '%s', expected like 181:7FF,280:7F0 (at most %d)\n", argv[5],
+                   CONTROLLER_CAN_FILTERS_MAX);
+            return 1;
         }
     }
-}
 
-int main(void)
-{
+    signal(SIGUSR1, controllerReportSignal);
+
     std::thread controller_thread(ControllerThread);
 
     cv::VideoCapture cap(0);
@@ -60,34 +56,83 @@ int main(void)
     cap.set(cv::CAP_PROP_FRAME_WIDTH,  320);
     cap.set(cv::CAP_PROP_FRAME_HEIGHT, 240);
 
+    // without a monitor on the car the images go to the client
+    image_proc_windows = debug_stream_kbps == 0;
+
     ImageProcInit();
 
-    InterPosList klass;
+    DebugStream stream;
+    debugStreamInit(&stream, debug_stream_kbps, monotonicUs());
+
+    // windows in milliseconds, the frame rate of the camera and the image processing varies
+    TimedInterPosList klass;
 
     cv::Mat frame;
 
     while (cv::waitKey(16) != 27) {
-        clock_t start = clock();
+        uint64_t start = monotonicUs();
 
         cap >> frame;
 
-        cv::imshow("frame", frame);
+        if (image_proc_windows) cv::imshow("frame", frame);
 
         InterPos state = ImageProcUpdate(frame);
-        klass.push(state);
+        klass.push(state, monotonicMs());
 
         blink = klass.analyze();
         //blink = klass.posAvg();
         
         ImageProcRender();
 
-        clock_t end = clock();
+        uint64_t end = monotonicUs();
+
+        bool            has_peer = false;
+        sockaddr_in     peer;
+        uint32_t        feedback;
+        CanFrame        feedback_last;
+        ControllerLink  link;
+
+        {
+            std::lock_guard<std::mutex> lock(telemetry_mutex);
+
+            has_peer        = client_has_peer;
+            peer            = client_peer;
+            feedback        = controller_can_feedback;
+            feedback_last   = controller_can_last;
+            link            = controller_link_shown;
+
+            telemetry_state.blink       = klass.blink;
+            telemetry_state.type        = klass.type;
+            telemetry_state.pos         = (int16_t)CLAMP(klass.pos * 1000.0f, -32767.0f, 32767.0f);
+            telemetry_state.decision_ms = (uint16_t)CLAMP(klass.decisionMs, 0, 65535);
+            telemetry_state.frame_ms    = (uint16_t)CLAMP_MAX((end - start) / 1000, 65535);
+        }
+
+        if (has_peer) debugStreamFrame(&stream, &peer, &map, mat_edge, monotonicUs());
 
         printf("ms: %d\n", (int)((end - start) / 1000));
 
         system("clear");
 
-        printf("blink %d\n", klass.blink);
+        printf("blink %d (%d ms to decision)\n", klass.blink, klass.decisionMs);
+        printf("link %s, lost %u times, failsafe %u us (max %u, %u of %u late)\n", link.lost? "LOST" : "ok",
+               link.lost_count, link.failsafe_latency_us, link.failsafe_latency_max_us, link.failsafe_late,
+               link.failsafe_count);
+        printf("packages %u, %u superseded, session %08x\n", link.received, link.superseded,
+               link.has_session? link.session : 0);
+        if (controller_can_period_ms) {
+            printf("can %s: every %d ms, %u updates, %u failed\n", controller_can_interface, controller_can_period_ms,
+                   controller_can_cyclic.updates, controller_can_cyclic.failed);
+        } else {
+            printf("can %s: %u sent, %u failed\n", controller_can_interface, controller_can.sent, controller_can.failed);
+        }
+
+        printf("can feedback: %u frames, %u dropped, last %03x\n", feedback,
+               controller_can_rx.ring.dropped.load(), feedback? feedback_last.frame.can_id : 0);
+
+        if (stream.kbps) debugStreamReport(&stream);
+
+        if (controller_report) controllerLinkReport(&link);
         printf("pos %.2f\n", klass.pos);
         printf("pos %d\n", klass.type);
 
@@ -107,7 +152,7 @@ int main(void)
 
     int dialate_count = 0;
 
-	InterPosList klassification;
+	InterPosList<> klassification;
 
     while (true) {
         int key = cv::waitKey(16);
@@ -133,16 +178,16 @@ int main(void)
             TilemapFillEdges(&map, capture.ptr(), capture.cols, capture.rows);
 
             for (int i = 0; i < dialate_count; ++i) {
-                TilemapDialate(&map);
+                TilemapDialate(&map, TILE_EDGE);
             }
         }
     
         {
-            TilemapFloodFill(&map,&map, map.width / 2, map.height - 1, TILE_ROAD);
+            TilemapFloodFillRoad(&map, map.width / 2, map.height - 1);
         }
 
         {
-            TilemapDrawRoadCenter(&map, &map,1);
+            TilemapDrawRoadCenter(&map, 1);
         }
 
         RoadState state = GetRoadState(&map); // type
@@ -4,6 +4,11 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <errno.h>
+
+// packets received with one call of netServerRecvBatch at most
+#define NET_RECV_BATCH  (16)
 
 #define LOCAL_HOST  ("127.0.0.1")
 
@@ -18,7 +23,7 @@ struct Client {
 };
 
 static void netServerInit(Server *server, int port) {
-	memset(server, 0, sizeof server);
+	memset(server, 0, sizeof *server);
 
 	server->socket = socket(AF_INET, SOCK_DGRAM, 0);
 
@@ -34,6 +39,58 @@ static int netServerRecv(Server *server, void *data, size_t data_size) {
 	return len;
 }
 
+// receives up to 'count' waiting packets without blocking, packet i goes to packets + i * packet_size, its length
+// to sizes[i] and its sender to addrs[i] when addrs is not NULL. returns how many were received, 0 when none were
+// waiting and < 0 on error
+static int netServerRecvBatch(Server *server, void *packets, size_t packet_size, int count, int *sizes,
+							  sockaddr_in *addrs = NULL) {
+	mmsghdr	msgs[NET_RECV_BATCH];
+	iovec	iovs[NET_RECV_BATCH];
+
+	if (count > NET_RECV_BATCH) count = NET_RECV_BATCH;
+
+	memset(msgs, 0, sizeof msgs);
+
+	for (int i = 0; i < count; ++i) {
+		iovs[i].iov_base			= (char *)packets + i * packet_size;
+		iovs[i].iov_len				= packet_size;
+
+		msgs[i].msg_hdr.msg_iov		= &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen	= 1;
+
+		if (addrs) {
+			msgs[i].msg_hdr.msg_name	= &addrs[i];
+			msgs[i].msg_hdr.msg_namelen	= sizeof addrs[i];
+		}
+	}
+
+	int n = recvmmsg(server->socket, msgs, count, MSG_DONTWAIT, NULL);
+
+	if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK)? 0 : -1;
+
+	for (int i = 0; i < n; ++i) {
+		// a longer packet than packet_size was cut off, it can not be valid
+		sizes[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)? -1 : (int)msgs[i].msg_len;
+	}
+
+	return n;
+}
+
+// sends a packet from the server socket without blocking, a full send buffer drops it
+static int netServerSend(Server *server, const sockaddr_in *to, const void *data, size_t data_size) {
+	return sendto(server->socket, data, data_size, MSG_DONTWAIT, (const sockaddr *)to, sizeof *to);
+}
+
+// waits at most timeout_ms for a packet, > 0 when one can be received, 0 on timeout and < 0 on error
+static int netServerWait(Server *server, int timeout_ms) {
+	pollfd fd = {0};
+
+	fd.fd		= server->socket;
+	fd.events	= POLLIN;
+
+	return poll(&fd, 1, timeout_ms);
+}
+
 #if 0
 static void netClientInit(Client *client, const char *ip, int port) {
 	memset(client, 0, sizeof client);
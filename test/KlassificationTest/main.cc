@@ -19,7 +19,7 @@ int main(void)
 
     ImageProcInit();
 
-    InterPosList klassList;
+    InterPosList<> klassList;
 
     while (true) {
         int key = cv::waitKey(1);
@@ -49,6 +49,7 @@ int main(void)
 
             printf("%d\n", (int)(end - start));
             printf("Klass blink %d\n", klassList.blink);
+            printf("Klass state %d, %d frames to decision\n", klassList.state(), klassList.decisionFrames);
             printf("Klass type %d\n", klassList.type);
             printf("Klass pos %.2f\n", klassList.pos);
             printf("Pos In %.2f\n", state.pos);
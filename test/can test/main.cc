@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include <thread>
+#include <atomic>
+
+#include "../../main/canlib.h"
+
+/* Checks canlib.h against a virtual CAN interface and measures how many frames canSend writes per second, how
+*  regular the cyclic frames of CanCyclic are and whether CanReceiver keeps up with a full 500 kbit/s bus.
+*
+*  usage: can_test [interface] [frames]
+*
+*  The interface is vcan0 by default. When it does not exist it is created, that needs root, otherwise the commands
+*  to create it are printed. The frames are read back on a second raw socket, vcan loops every frame back to the
+*  other sockets on the interface like a real bus would.
+*/
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool createInterface(const char *name)
+{
+    if (if_nametoindex(name)) return true;
+
+    if (geteuid() != 0) {
+        printf("%s does not exist, create it with\n"
+               "    sudo modprobe vcan\n"
+               "    sudo ip link add dev %s type vcan\n"
+               "    sudo ip link set up %s\n", name, name, name);
+        return false;
+    }
+
+    char command[256];
+    snprintf(command, sizeof command, "modprobe vcan; ip link add dev %s type vcan && ip link set up %s", name, name);
+
+    if (system(command) != 0 || !if_nametoindex(name)) {
+        printf("could not create %s\n", name);
+        return false;
+    }
+
+    printf("created %s\n", name);
+
+    return true;
+}
+
+// a socket that receives every frame on the interface
+static int openReader(const char *name)
+{
+    int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    sockaddr_can addr = {0};
+    addr.can_family   = AF_CAN;
+    addr.can_ifindex  = if_nametoindex(name);
+
+    // a big receive buffer, so the reader keeps up with the throughput test
+    int size = 8 << 20;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, &size, sizeof size);
+
+    timeval tv = { 0, 200000 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+
+    if (bind(s, (sockaddr *)&addr, sizeof addr) < 0) {
+        printf("could not bind the reader to %s: %s\n", name, strerror(errno));
+        close(s);
+        return -1;
+    }
+
+    return s;
+}
+
+static void testErrors(void)
+{
+    Can can;
+
+    check(!canInit(&can, "nocan9"), "canInit on a missing interface fails");
+    check(can.socket < 0, "the socket is closed after a failed canInit");
+
+    uint8_t data[8] = {0};
+    check(!canSend(&can, 0x100, data, 8), "canSend without a socket fails");
+    check(can.failed == 1 && can.last_error == EBADF, "the failed send is counted with its errno");
+
+    CanCyclic cc;
+
+    check(!canCyclicInit(&cc, "nocan9", 0x100, data, 8, 10000), "canCyclicInit on a missing interface fails");
+    check(cc.socket < 0, "the socket is closed after a failed canCyclicInit");
+
+    static CanReceiver rx;
+
+    check(!canReceiverStart(&rx, "nocan9"), "canReceiverStart on a missing interface fails");
+    check(rx.socket < 0 && !rx.thread.joinable(), "no thread after a failed canReceiverStart");
+}
+
+// frames of every length and a range of ids arrive in order and unchanged
+static void testFrames(const char *name, int reader)
+{
+    Can can;
+
+    check(canInit(&can, name), "canInit on the test interface");
+
+    for (int i = 0; i < 1000; ++i) {
+        uint8_t  data[12];
+        unsigned id   = 0x100 + i % 0x600;
+        int      size = i % 13;     // more than 8 is cut to 8
+
+        for (int j = 0; j < 12; ++j) data[j] = (uint8_t)(i * 7 + j);
+
+        check(canSend(&can, id, data, size), "canSend");
+
+        can_frame frame;
+
+        if (read(reader, &frame, sizeof frame) != sizeof frame) {
+            check(false, "frame read back");
+            break;
+        }
+
+        int dlc = size > 8? 8 : size;
+
+        check(frame.can_id == id, "id");
+        check(frame.can_dlc == dlc, "length");
+        check(memcmp(frame.data, data, dlc) == 0, "data");
+    }
+
+    check(can.sent == 1000 && can.failed == 0, "sent and failed counters");
+
+    canDeinit(&can);
+}
+
+// the kernel repeats the frame with the period, an update goes out right away and then keeps repeating
+static void testCyclic(const char *name, int reader)
+{
+    const int period_us = 10000;
+
+    uint8_t data[8] = { 1 };
+
+    CanCyclic cc;
+
+    check(canCyclicInit(&cc, name, 0x7DF, data, 8, period_us), "canCyclicInit on the test interface");
+
+    can_frame   frame;
+    int         count       = 0;
+    double      last        = 0;
+    double      worst_us    = 0;
+    double      start       = seconds();
+
+    while (seconds() - start < 0.5) {
+        if (read(reader, &frame, sizeof frame) != sizeof frame) break;
+
+        double now = seconds();
+
+        check(frame.can_id == 0x7DF && frame.data[0] == 1, "the cyclic frame");
+
+        if (count++) {
+            double off = fabs((now - last) * 1e6 - period_us);
+            if (off > worst_us) worst_us = off;
+        }
+
+        last = now;
+    }
+
+    // the first one is sent right away
+    check(count >= 45 && count <= 55, "about 50 frames in 0.5 s");
+
+    data[0] = 2;
+
+    double update = seconds();
+
+    check(canCyclicUpdate(&cc, data, 8), "canCyclicUpdate");
+    check(read(reader, &frame, sizeof frame) == sizeof frame && frame.data[0] == 2, "the update is sent");
+
+    double update_us = (seconds() - update) * 1e6;
+
+    check(update_us < period_us / 2, "the update is sent right away");
+    check(canCyclicUpdate(&cc, data, 8) && cc.updates == 1, "the same data again is no update");
+
+    for (int i = 0; i < 5; ++i) {
+        check(read(reader, &frame, sizeof frame) == sizeof frame && frame.data[0] == 2, "the update repeats");
+    }
+
+    canCyclicDeinit(&cc);
+
+    // what was in flight, then nothing until the receive timeout
+    while (read(reader, &frame, sizeof frame) == sizeof frame && seconds() - update < 2) {}
+    check(seconds() - update < 2, "nothing is sent after canCyclicDeinit");
+
+    printf("canCyclic: %d frames every %d us, worst %.0f us off, update after %.0f us\n", count, period_us, worst_us,
+           update_us);
+}
+
+// the ring on its own, then a producer and a consumer thread hammering it
+static void testRing(void)
+{
+    static CanRing ring;
+
+    CanFrame f = {0};
+
+    check(!canRingPop(&ring, &f), "an empty ring");
+
+    for (int i = 0; i < CAN_RING_SIZE + 10; ++i) {
+        f.time_ns = i;
+        canRingPush(&ring, &f);
+    }
+
+    check(ring.dropped.load() == 10, "a full ring drops the newest");
+
+    for (int i = 0; i < CAN_RING_SIZE; ++i) {
+        check(canRingPop(&ring, &f) && f.time_ns == (uint64_t)i, "frames come out in order");
+    }
+
+    check(!canRingPop(&ring, &f), "empty again");
+
+    const uint64_t count = 1000000;
+
+    ring.dropped.store(0);
+
+    std::thread producer([&]() {
+        CanFrame p = {0};
+
+        for (uint64_t i = 0; i < count; ++i) {
+            p.time_ns = i;
+            memcpy(p.frame.data, &i, 8);
+
+            while (!canRingPush(&ring, &p)) std::this_thread::yield();
+        }
+    });
+
+    uint64_t next  = 0;
+    bool     order = true;
+
+    double start = seconds();
+
+    while (next < count) {
+        if (!canRingPop(&ring, &f)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint64_t data;
+        memcpy(&data, f.frame.data, 8);
+
+        if (f.time_ns != next || data != next) order = false;
+        next++;
+    }
+
+    double elapsed = seconds() - start;
+
+    producer.join();
+
+    check(order, "every frame between two threads in order and whole");
+
+    printf("CanRing: %.0f frames/s between two threads\n", count / elapsed);
+}
+
+// only the frames that pass the filters reach the ring
+static void testFilters(const char *name)
+{
+    static CanReceiver rx;
+
+    can_filter filters[4];
+
+    check(canParseFilters("100,280:7F0", filters, 4) == 2, "canParseFilters");
+    check(filters[0].can_id == 0x100 && filters[0].can_mask == CAN_SFF_MASK, "an id without a mask");
+    check(filters[1].can_id == 0x280 && filters[1].can_mask == 0x7F0, "an id with a mask");
+    check(canParseFilters("100;200", filters, 4) < 0, "a bad filter");
+    check(canParseFilters("1,2,3,4,5", filters, 4) < 0, "too many filters");
+
+    canParseFilters("100,280:7F0", filters, 4);
+
+    check(canReceiverStart(&rx, name, filters, 2), "canReceiverStart");
+
+    Can can;
+    canInit(&can, name);
+
+    unsigned ids[] = { 0x100, 0x101, 0x280, 0x28F, 0x290, 0x7DF };
+
+    for (unsigned id : ids) canSend(&can, id, &id, sizeof id);
+
+    usleep(50000);
+
+    CanFrame    f       = {0};
+    unsigned    got[8];
+    int         count   = 0;
+
+    while (count < 8 && canRingPop(&rx.ring, &f)) got[count++] = f.frame.can_id;
+
+    check(count == 3 && got[0] == 0x100 && got[1] == 0x280 && got[2] == 0x28F, "the filters pass 100 and 280 to 28F");
+    check(f.time_ns != 0, "the frames have a timestamp");
+
+    canDeinit(&can);
+    canReceiverStop(&rx);
+}
+
+static int compareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* A sender paced like a full 500 kbit/s bus, about 4000 frames/s of 8 bytes, and a control loop that polls the ring
+*  every millisecond. Every frame has to arrive, in order, and the time from the kernel timestamp to the poll shows
+*  how old the feedback is when the loop sees it.
+*/
+static void testBusLoad(const char *name, double duration)
+{
+    static CanReceiver rx;
+
+    const int   rate    = 4000;
+    const int   count   = (int)(rate * duration);
+
+    if (!canReceiverStart(&rx, name)) return;
+
+    Can can;
+
+    if (!canInit(&can, name)) {
+        canReceiverStop(&rx);
+        return;
+    }
+
+    std::thread sender([&]() {
+        timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+
+        for (int i = 0; i < count; ++i) {
+            uint8_t data[8] = {0};
+            memcpy(data, &i, sizeof i);
+
+            canSend(&can, 0x181, data, 8);
+
+            next.tv_nsec += 1000000000 / rate;
+            if (next.tv_nsec >= 1000000000) { next.tv_sec++; next.tv_nsec -= 1000000000; }
+
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    });
+
+    uint32_t    *ages       = (uint32_t *)malloc(count * sizeof (uint32_t));
+    int         received    = 0;
+    int         next        = 0;
+    bool        order       = true;
+    double      end         = seconds() + duration + 1;
+
+    while (received < count && seconds() < end) {
+        usleep(1000);
+
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+
+        CanFrame f;
+
+        while (received < count && canRingPop(&rx.ring, &f)) {
+            int i;
+            memcpy(&i, f.frame.data, sizeof i);
+
+            if (i != next) order = false;
+            next = i + 1;
+
+            ages[received++] = (uint32_t)((now_ns - f.time_ns) / 1000);
+        }
+    }
+
+    sender.join();
+
+    check(received == count, "every frame of the full bus arrives");
+    check(order, "the frames arrive in order");
+    check(rx.ring.dropped.load() == 0, "nothing is dropped by the ring");
+
+    if (received) {
+        qsort(ages, received, sizeof (uint32_t), compareU32);
+
+        printf("CanReceiver: %d of %d frames at %d frames/s, %u dropped, age at the poll p50 %u us p99 %u us "
+               "max %u us\n", received, count, rate, rx.ring.dropped.load(), ages[received / 2], ages[received * 99 / 100],
+               ages[received - 1]);
+    }
+
+    free(ages);
+
+    canDeinit(&can);
+    canReceiverStop(&rx);
+}
+
+static void testThroughput(const char *name, int reader, int count)
+{
+    Can can;
+
+    if (!canInit(&can, name)) return;
+
+    std::atomic<bool>   done(false);
+    std::atomic<int>    received(0);
+
+    // reads until the receive timeout once the sender is done
+    std::thread thread([&]() {
+        can_frame frame;
+
+        while (1) {
+            if (read(reader, &frame, sizeof frame) == sizeof frame) received++;
+            else if (done) break;
+        }
+    });
+
+    uint8_t data[8] = {0};
+
+    double start = seconds();
+
+    for (int i = 0; i < count; ++i) {
+        memcpy(data, &i, sizeof i);
+        canSend(&can, 0x7DF, data, 8);
+    }
+
+    double elapsed = seconds() - start;
+
+    done = true;
+    thread.join();
+
+    printf("canSend: %d frames in %.3f s, %.0f frames/s, %u failed, %d read back\n", count, elapsed,
+           can.sent / elapsed, can.failed, (int)received);
+
+    // a 500 kbit/s bus carries about 4000 frames/s with 8 bytes of data
+    printf("         %.0fx a full 500 kbit/s bus\n", can.sent / elapsed / 4000.0);
+
+    canDeinit(&can);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name  = argc > 1? argv[1] : "vcan0";
+    int         count = argc > 2? atoi(argv[2]) : 1000000;
+
+    testErrors();
+    testRing();
+
+    if (!createInterface(name)) return 1;
+
+    int reader = openReader(name);
+    if (reader < 0) return 1;
+
+    testFrames(name, reader);
+    testCyclic(name, reader);
+    testFilters(name);
+    testBusLoad(name, 2.0);
+
+    if (failures) printf("%d failures\n", failures);
+    else          puts("all passed");
+
+    testThroughput(name, reader, count);
+
+    close(reader);
+
+    return failures != 0;
+}
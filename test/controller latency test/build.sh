@@ -0,0 +1,3 @@
+#!/bin/sh
+# needs SocketCAN, so linux only
+g++ main.cc -o ../bin/controller_latency_test -std=c++17 -O2 -lpthread
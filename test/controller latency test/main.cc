@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "../../lib/stats.cc"
+#include "../../lib/crc32.h"
+#include "../../main/canlib.h"
+#include "../../main/net.h"
+#include "../../controller/controller.c"
+#include "../../main/controller_thread.h"
+
+/* Time from a ControllerPackage leaving a client to its CAN frame, through the ControllerThread of the car.
+*
+*  usage: controller_latency [interface] [seconds per rate]
+*
+*  ControllerThread runs in this process against 'interface' (vcan0 by default, set it up with
+*      sudo modprobe vcan && sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0)
+*  and gets its packages over loopback. A raw CAN socket on the same interface reads the frames back with kernel
+*  receive timestamps, the latency is that timestamp minus the time right before the package was sent, both
+*  CLOCK_REALTIME.
+*
+*  Every package carries its number in thrust and steering, so each frame is matched to the package it came from.
+*  Failsafe frames have zero thrust and are not counted.
+*
+*  The rate doubles from 500 packages/s until the car falls behind. The sustainable rate is the highest one where
+*  every package became its own frame (at most 1% superseded or lost) with the 99th percentile under 1 ms.
+*/
+
+#define PORT                (8893)
+#define CAN_ID              (0x7DF)
+#define MATCH_COUNT         (127 * 127)
+#define SUSTAINABLE_P99_US  (1000)
+
+static uint64_t realtimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// package number to send time, read by the receive thread
+static std::atomic<uint64_t>    send_ns[MATCH_COUNT];
+static std::atomic<bool>        running(true);
+
+struct Step {
+    int                     rate;
+    int                     sent;
+    std::vector<uint32_t>   latencies;      // us
+};
+
+// the step being measured, NULL between steps
+static Step         *current_step = NULL;
+static std::mutex   step_mutex;
+
+static Controller controllerOf(int number)
+{
+    Controller c = {0};
+
+    c.thrust    = (int8_t)(1 + number % 127);
+    c.steering  = (int8_t)(number / 127 % 127);
+
+    return c;
+}
+
+static int numberOf(const can_frame *frame)
+{
+    int thrust   = (int8_t)frame->data[0];
+    int steering = (int8_t)frame->data[1];
+
+    if (thrust <= 0) return -1;
+
+    return steering * 127 + thrust - 1;
+}
+
+static void receiveThread(int socket)
+{
+    std::vector<uint8_t> seen(MATCH_COUNT);
+
+    while (running) {
+        can_frame   frame;
+        iovec       iov     = { &frame, sizeof frame };
+        char        control[CMSG_SPACE(sizeof (timespec))];
+        msghdr      msg     = {0};
+
+        msg.msg_iov         = &iov;
+        msg.msg_iovlen      = 1;
+        msg.msg_control     = control;
+        msg.msg_controllen  = sizeof control;
+
+        if (recvmsg(socket, &msg, 0) < (int)sizeof frame) continue;
+        if (frame.can_id != CAN_ID) continue;
+
+        uint64_t received = 0;
+
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_TIMESTAMPNS) {
+                timespec ts;
+                memcpy(&ts, CMSG_DATA(c), sizeof ts);
+
+                received = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+            }
+        }
+
+        int number = numberOf(&frame);
+
+        if (number < 0 || !received) continue;
+
+        uint64_t sent = send_ns[number].exchange(0);
+
+        std::lock_guard<std::mutex> lock(step_mutex);
+
+        if (current_step && sent && received >= sent) {
+            current_step->latencies.push_back((uint32_t)((received - sent) / 1000));
+        }
+    }
+}
+
+static void printStep(Step *step)
+{
+    std::vector<uint32_t> &l = step->latencies;
+
+    std::sort(l.begin(), l.end());
+
+    int n = (int)l.size();
+
+    printf("%7d/s  sent %7d  framed %7d (%5.1f%%)", step->rate, step->sent, n, step->sent? 100.0 * n / step->sent : 0);
+
+    if (n) {
+        printf("  min %4u  p50 %4u  p90 %4u  p99 %5u  max %6u us", l[0], l[n / 2], l[n * 90 / 100], l[n * 99 / 100],
+               l[n - 1]);
+    }
+
+    printf("\n");
+}
+
+static bool sustainable(const Step *step)
+{
+    int n = (int)step->latencies.size();
+
+    return n && n >= step->sent * 99 / 100 && step->latencies[n * 99 / 100] < SUSTAINABLE_P99_US;
+}
+
+int main(int argc, char **argv)
+{
+    const char *interface   = argc > 1? argv[1] : "vcan0";
+    double      seconds     = argc > 2? atof(argv[2]) : 2.0;
+
+    // the reader, opened first so it fails before the car does
+    int can_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    {
+        ifreq ifr = {0};
+        snprintf(ifr.ifr_name, sizeof ifr.ifr_name, "%s", interface);
+
+        if (can_socket < 0 || ioctl(can_socket, SIOCGIFINDEX, &ifr) < 0) {
+            printf("no CAN interface %s: %s\n", interface, strerror(errno));
+            return 1;
+        }
+
+        sockaddr_can addr = {0};
+        addr.can_family   = AF_CAN;
+        addr.can_ifindex  = ifr.ifr_ifindex;
+
+        int on = 1;
+        setsockopt(can_socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on);
+
+        // wakes up the receive thread once a second so it sees the end
+        timeval tv = { 1, 0 };
+        setsockopt(can_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+
+        if (bind(can_socket, (sockaddr *)&addr, sizeof addr) < 0) {
+            printf("could not bind to %s: %s\n", interface, strerror(errno));
+            return 1;
+        }
+    }
+
+    controller_port             = PORT;
+    controller_can_interface    = interface;
+    controller_timeout_ms       = 1000;
+
+    std::thread car(ControllerThread);
+    car.detach();
+
+    std::thread receiver(receiveThread, can_socket);
+
+    int         client  = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in to      = {0};
+
+    to.sin_family       = AF_INET;
+    to.sin_port         = htons(PORT);
+    to.sin_addr.s_addr  = inet_addr(LOCAL_HOST);
+
+    usleep(100000);
+
+    printf("%s, %.1f s per rate\n\n", interface, seconds);
+
+    uint32_t    sequence    = 1;
+    int         best        = 0;
+
+    for (int rate = 500; rate <= 256000; rate *= 2) {
+        Step step;
+        step.rate = rate;
+
+        for (int i = 0; i < MATCH_COUNT; ++i) send_ns[i] = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(step_mutex);
+            current_step = &step;
+        }
+
+        int         count   = (int)(rate * seconds);
+        uint64_t    period  = 1000000000 / rate;
+        uint64_t    start   = realtimeNs();
+
+        for (int i = 0; i < count; ++i) {
+            // paced to absolute send times, a late package goes right away
+            while (realtimeNs() < start + i * period);
+
+            int                 number  = i % MATCH_COUNT;
+            ControllerPackage   cp      = ControllerPackageCreate(controllerOf(number), 1, 0, 0, sequence++,
+                                                                  (uint32_t)monotonicUs());
+
+            send_ns[number] = realtimeNs();
+            sendto(client, &cp, sizeof cp, 0, (sockaddr *)&to, sizeof to);
+
+            step.sent++;
+        }
+
+        // the last frames of the step
+        usleep(50000);
+
+        {
+            std::lock_guard<std::mutex> lock(step_mutex);
+            current_step = NULL;
+        }
+
+        printStep(&step);
+
+        if (!sustainable(&step)) break;
+
+        best = rate;
+    }
+
+    printf("\nsustainable: %d packages/s\n", best);
+    printf("link: %u received, %u superseded, %u stale, %u out of order\n", controller_link.received,
+           controller_link.superseded, controller_link.stale, controller_link.out_of_order);
+
+    running = false;
+    receiver.join();
+
+    controllerStop();
+
+    return 0;
+}
@@ -40,11 +40,11 @@ int main(void)
 
     TilemapFillEdges(&map, capture.ptr(), capture.cols, capture.rows);
 
-    TilemapFloodFill(&map, &map, map.width / 2, map.height - 1, TILE_ROAD);
+    TilemapFloodFillRoad(&map, map.width / 2, map.height - 1);
 
     RoadState state = TilemapGetRoadState(&map);
 
-    float per = TilemapDrawRoadCenter(&map, &map);
+    float per = TilemapDrawRoadCenter(&map);
 
     printf("center edge per: %f\n", per);
 
@@ -151,7 +151,7 @@ int main(void)
             TilemapFillEdges(&map, capture.ptr(), capture.cols, capture.rows);
 
             for (int i = 0; i < dialate_count; ++i) {
-                TilemapDialate(&map);
+                TilemapDialate(&map, TILE_EDGE);
             }
 
             clock_t end = clock();
@@ -161,13 +161,13 @@ int main(void)
 
         {
             clock_t start = clock();
-            TilemapFloodFill(&map, &map, map.width / 2, map.height - 1, TILE_ROAD);
+            TilemapFloodFillRoad(&map, map.width / 2, map.height - 1);
             clock_t end = clock();
 
             printf("FloodFill ms: %d\n", (int)(end - start));
         }
 
-        TilemapDrawRoadCenter(&map, &map, 0);
+        TilemapDrawRoadCenter(&map, 0);
 
         RoadState state = TilemapGetRoadState(&map);
         float     pos   = TilemapGetRoadPosition(&map, state);
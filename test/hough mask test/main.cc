@@ -46,7 +46,7 @@ int main(void)
 
     ImageProcInit();
 
-    InterPosList klassList;
+    InterPosList<> klassList;
 
     while (true) {
         int key = cv::waitKey(1);
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <cmath>
+#include <vector>
+
+#include "../../lib/klass_batch.cc"
+
+// checks that InterPosBatch gives exactly the results of one InterPosList per stream, and times both.
+
+static int failures = 0;
+
+template <int Window, int DiffWindow>
+static void TestBatch(int lanes, int steps)
+{
+    std::vector<int32_t>    types(lanes * steps);
+    std::vector<float>      positions(lanes * steps);
+    std::vector<int8_t>     blinks(lanes * steps);
+
+    // every lane drives through its own mix of road types while drifting across the road
+    for (int l = 0; l < lanes; ++l) {
+        float phase = (rand() % 1000) * 0.01f;
+        float speed = 0.005f + (rand() % 100) * 0.0005f;
+
+        for (int t = 0; t < steps; ++t) {
+            int type = ((t + l * 13) / (20 + l % 30)) % 9;
+
+            if (rand() % 6 == 0) type = rand() % 16;
+
+            types[t * lanes + l]     = type;
+            positions[t * lanes + l] = sinf(phase + t * speed) + (rand() % 100 - 50) * 0.001f;
+        }
+    }
+
+    InterPosBatch<Window, DiffWindow> batch;
+    batch.init(lanes);
+
+    clock_t batch_start = clock();
+    batch.run(types.data(), positions.data(), steps, blinks.data());
+    clock_t batch_end = clock();
+
+    int lane_failures = 0;
+
+    clock_t scalar_start = clock();
+
+    for (int l = 0; l < lanes; ++l) {
+        InterPosList<Window, DiffWindow> list;
+
+        for (int t = 0; t < steps; ++t) {
+            list.push({ types[t * lanes + l], positions[t * lanes + l] });
+
+            int blink = list.analyze();
+
+            if (blink != blinks[t * lanes + l]) {
+                if (!lane_failures) printf("FAIL lane %d step %d: batch %d, list %d\n", l, t, blinks[t * lanes + l], blink);
+                lane_failures++;
+            }
+        }
+    }
+
+    clock_t scalar_end = clock();
+
+    failures += lane_failures;
+
+    printf("window %2d/%-2d %5d lanes x %5d steps: batch %6.1f ms, list %6.1f ms\n", Window, DiffWindow, lanes, steps,
+           1000.0 * (batch_end - batch_start) / CLOCKS_PER_SEC, 1000.0 * (scalar_end - scalar_start) / CLOCKS_PER_SEC);
+
+    batch.destroy();
+}
+
+int main(void)
+{
+    srand(1);
+
+    TestBatch<10, 5>(1, 1000);
+    TestBatch<10, 5>(7, 1000);
+    TestBatch<10, 5>(1024, 2000);
+    TestBatch<4, 8>(333, 1000);
+    TestBatch<30, 10>(256, 2000);
+
+    if (failures) printf("%d failures\n", failures);
+    else          puts("all passed");
+
+    return failures != 0;
+}
@@ -0,0 +1,3 @@
+@echo off
+cd ../bin/
+klass_sweep.exe %*
@@ -0,0 +1,324 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "../../lib/klass.cc"
+
+/* Searches the KlassParams for the best blink classification on labeled position logs.
+*
+*  usage: klass_sweep [-random count] [-seed n] [-threads n] [-top n] [-maxfalse percent] log[=label] ...
+*
+*  A log has one sample per line, "type pos [label]" where label is the expected blink, -1, 0 or 1. 'log=label' labels
+*  every line of the file that has no label of its own, samples without any label are run but not scored.
+*
+*  The logs are loaded once, then every parameter set (a grid, or 'count' random sets) runs over all of them on all
+*  cores. Reported per set:
+*    accuracy   samples where the blink matches the label
+*    false      samples labeled 0 that blink anyway
+*    latency    frames from the label changing to a blink until the classifier gives that blink
+*    missed     blink labels the classifier never gave before the label changed again
+*
+*  The sets with the best accuracy are listed first. With -maxfalse only the sets that stay under that false blink
+*  rate are listed, the ones that give the most labeled blinks first and the lowest latency among those.
+*/
+
+static const int NO_LABEL = -128;
+
+struct Log {
+    const char          *name;
+    std::vector<InterPos> samples;
+    std::vector<int8_t>   labels;
+};
+
+struct Result {
+    KlassParams params;
+
+    int scored = 0;
+    int correct = 0;
+    int negatives = 0;
+    int falseBlinks = 0;
+
+    int events = 0;
+    int detected = 0;
+    int latencySum = 0;
+    int latencyMax = 0;
+
+    double accuracy() const      { return scored? 100.0 * correct / scored : 0; }
+    double falseRate() const     { return negatives? 100.0 * falseBlinks / negatives : 0; }
+    double latency() const       { return detected? (double)latencySum / detected : 0; }
+};
+
+static bool LoadLog(const char *arg, Log *log)
+{
+    char path[1024];
+    int  fileLabel = NO_LABEL;
+
+    snprintf(path, sizeof path, "%s", arg);
+
+    char *eq = strrchr(path, '=');
+    if (eq) {
+        *eq = 0;
+        fileLabel = atoi(eq + 1);
+    }
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("could not open %s\n", path);
+        return false;
+    }
+
+    log->name = arg;
+
+    char line[256];
+    while (fgets(line, sizeof line, f)) {
+        InterPos sample;
+        int      label = fileLabel;
+
+        int n = sscanf(line, "%d %f %d", &sample.type, &sample.pos, &label);
+        if (n < 2) continue;
+
+        log->samples.push_back(sample);
+        log->labels.push_back((int8_t)label);
+    }
+
+    fclose(f);
+
+    return true;
+}
+
+static void Evaluate(const std::vector<Log> &logs, Result *result)
+{
+    InterPosListDynamic klass;
+
+    for (const Log &log : logs) {
+        klass.init(result->params);
+
+        int prevLabel = 0;
+        int pending = 0;        // the blink label waiting for the classifier, 0 for none
+        int pendingStart = 0;
+
+        for (int t = 0; t < (int)log.samples.size(); ++t) {
+            klass.push(log.samples[t]);
+
+            int blink = klass.analyze();
+            int label = log.labels[t];
+
+            if (label == NO_LABEL) continue;
+
+            result->scored++;
+            result->correct += blink == label;
+
+            if (label == 0) {
+                result->negatives++;
+                result->falseBlinks += blink != 0;
+            }
+
+            if (label != prevLabel) {
+                pending = 0;
+
+                if (label != 0) {
+                    pending = label;
+                    pendingStart = t;
+                    result->events++;
+                }
+            }
+
+            if (pending && blink == pending) {
+                int latency = t - pendingStart;
+
+                result->detected++;
+                result->latencySum += latency;
+                result->latencyMax = std::max(result->latencyMax, latency);
+
+                pending = 0;
+            }
+
+            prevLabel = label;
+        }
+    }
+}
+
+static float RandomRange(float lo, float hi)
+{
+    return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+static void GridParams(std::vector<Result> *results)
+{
+    static const int    windows[]    = { 4, 6, 10, 14, 20 };
+    static const int    diffs[]      = { 2, 3, 5, 8 };
+    static const int    percents[]   = { 50, 70, 80, 90 };
+    static const double turns[]      = { 0.3, 0.4, 0.5, 0.6 };
+    static const double laneDifs[]   = { 0.0, 0.02, 0.03, 0.05 };
+    static const int    entries[]    = { 1, 2, 3 };
+    static const int    exits[]      = { 1, 3 };
+    static const int    holds[]      = { 0, 10 };
+
+    for (int window : windows)
+    for (int diff : diffs)
+    for (int percent : percents)
+    for (double turn : turns)
+    for (double laneDif : laneDifs)
+    for (int entry : entries)
+    for (int exit : exits)
+    for (int hold : holds) {
+        Result result;
+
+        result.params.window        = window;
+        result.params.diffWindow    = diff;
+        result.params.typePercent   = percent;
+        result.params.turnPos       = turn;
+        result.params.laneChangeDif = laneDif;
+        result.params.entryFrames   = entry;
+        result.params.exitFrames    = exit;
+        result.params.minHoldFrames = hold;
+
+        results->push_back(result);
+    }
+}
+
+static void RandomParams(std::vector<Result> *results, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        Result result;
+
+        // the dynamic window holds DYNAMIC_CAPACITY samples
+        result.params.window        = 2 + rand() % 39;
+        result.params.diffWindow    = 1 + rand() % 20;
+        result.params.typePercent   = 30 + rand() % 66;
+        result.params.turnPos       = RandomRange(0.1f, 0.9f);
+        result.params.laneChangeDif = RandomRange(0.0f, 0.15f);
+        result.params.turnHysteresis = RandomRange(0.0f, 0.3f);
+        result.params.entryFrames   = 1 + rand() % 5;
+        result.params.exitFrames    = 1 + rand() % 8;
+        result.params.minHoldFrames = rand() % 30;
+
+        results->push_back(result);
+    }
+}
+
+static void PrintResult(const Result &r)
+{
+    printf("window %2d diff %2d type %2d%% turn %.3f/%.3f lane %.3f frames %d/%d/%2d | accuracy %6.2f%% false %6.2f%% "
+           "latency %5.2f (max %3d) missed %d/%d\n",
+           r.params.window, r.params.diffWindow, r.params.typePercent, r.params.turnPos, r.params.turnHysteresis,
+           r.params.laneChangeDif, r.params.entryFrames, r.params.exitFrames, r.params.minHoldFrames, r.accuracy(), r.falseRate(), r.latency(), r.latencyMax, r.events - r.detected, r.events);
+}
+
+int main(int argc, char **argv)
+{
+    int randomCount = 0;
+    int seed = 1;
+    int threadCount = (int)std::thread::hardware_concurrency();
+    int top = 20;
+    double maxFalse = -1;
+
+    std::vector<Log> logs;
+
+    for (int i = 1; i < argc; ++i) {
+        if      (!strcmp(argv[i], "-random")  && i + 1 < argc) randomCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-seed")    && i + 1 < argc) seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-threads") && i + 1 < argc) threadCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-top")     && i + 1 < argc) top = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-maxfalse") && i + 1 < argc) maxFalse = atof(argv[++i]);
+        else {
+            Log log;
+            if (!LoadLog(argv[i], &log)) return 1;
+
+            logs.push_back(log);
+        }
+    }
+
+    if (logs.empty()) {
+        puts("usage: klass_sweep [-random count] [-seed n] [-threads n] [-top n] [-maxfalse percent] log[=label] ...");
+        return 1;
+    }
+
+    if (threadCount < 1) threadCount = 1;
+
+    int samples = 0;
+    for (const Log &log : logs) samples += (int)log.samples.size();
+
+    std::vector<Result> results;
+
+    srand(seed);
+
+    if (randomCount) RandomParams(&results, randomCount);
+    else             GridParams(&results);
+
+    printf("%d logs, %d samples, %d parameter sets on %d threads\n", (int)logs.size(), samples, (int)results.size(),
+           threadCount);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // the sets are handed out in small chunks so that threads that get fast sets take more of them
+    {
+        std::atomic<int> next(0);
+        std::vector<std::thread> threads;
+
+        const int chunk = 16;
+
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&]() {
+                for (;;) {
+                    int first = next.fetch_add(chunk);
+                    if (first >= (int)results.size()) break;
+
+                    int last = std::min(first + chunk, (int)results.size());
+
+                    for (int r = first; r < last; ++r) Evaluate(logs, &results[r]);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads) thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%.2f s, %.0f sets/s, %.1f M samples/s\n\n", seconds, results.size() / seconds,
+           (double)samples * results.size() / seconds / 1e6);
+
+    if (maxFalse >= 0) {
+        results.erase(std::remove_if(results.begin(), results.end(), [&](const Result &r) {
+            return r.falseRate() > maxFalse;
+        }), results.end());
+
+        // most blinks given first, the latency only averages over those, so a set that misses blinks would look
+        // fast. the lower latency and then the better accuracy win a tie
+        std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+            if (a.detected != b.detected)       return a.detected > b.detected;
+            if (a.latency() != b.latency())     return a.latency() < b.latency();
+            return a.accuracy() > b.accuracy();
+        });
+
+        printf("%d sets with at most %.2f%% false blinks\n", (int)results.size(), maxFalse);
+    }
+    else {
+        // best accuracy first, the lower latency and fewer false blinks win a tie
+        std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+            if (a.accuracy() != b.accuracy())   return a.accuracy() > b.accuracy();
+            if (a.latency() != b.latency())     return a.latency() < b.latency();
+            return a.falseRate() < b.falseRate();
+        });
+    }
+
+    for (int i = 0; i < top && i < (int)results.size(); ++i) PrintResult(results[i]);
+
+    Result current;
+    Evaluate(logs, &current);
+
+    printf("\ncurrent:\n");
+    PrintResult(current);
+
+    return 0;
+}
@@ -0,0 +1,3 @@
+@echo off
+cd ../bin/
+net_rtt_test.exe %*
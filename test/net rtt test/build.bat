@@ -0,0 +1,2 @@
+@echo off
+gcc main.c -o ../bin/net_rtt_test.exe -std=gnu11 -O2 -lws2_32
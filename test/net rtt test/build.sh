@@ -0,0 +1,2 @@
+#!/bin/sh
+gcc main.c -o ../bin/net_rtt_test -std=gnu11 -O2 -lm
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../controller/ats/ats_net.h"
+#include "../../controller/controller.c"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* Round trip times of ControllerPackage sized UDP packets through ats_net.h.
+*
+*  usage: net_rtt [count]                      client and echo server in this process over loopback
+*         net_rtt echo [port]                  echo server for a client on another machine
+*         net_rtt ping ip [port] [count]       client against a running echo server
+*
+*  Every round trip is timed once with a blocking client socket and once with a non blocking one that spins on
+*  NetClientRecv, the difference is the wake up of a blocked recv. In the loopback mode the echo is answered in the
+*  same thread between the send and the recv, so only the socket calls and the network stack are measured.
+*/
+
+#define PORT    (8890)
+
+static uint64_t TimeUs(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (uint64_t)(counter.QuadPart * 1000000.0 / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static int CompareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void PrintTimes(const char *name, uint32_t *times, int count, int lost)
+{
+    if (count == 0)
+    {
+        printf("%-12s no answers, %d lost\n", name, lost);
+        return;
+    }
+
+    qsort(times, count, sizeof *times, CompareU32);
+
+    printf("%-12s n %6d  min %5u us  p50 %5u us  p90 %5u us  p99 %5u us  max %6u us  lost %d\n", name, count,
+           times[0], times[count / 2], times[count * 90 / 100], times[count * 99 / 100], times[count - 1], lost);
+}
+
+// answers one waiting package, returns 0 when none was waiting
+static int Echo(Server *server)
+{
+    ControllerPackage   cp;
+    struct sockaddr_in  from;
+
+    int size = NetServerRecvFrom(server, &cp, sizeof cp, &from);
+
+    if (size <= 0) return 0;
+
+    NetServerSend(server, &from, &cp, size);
+
+    return 1;
+}
+
+static void RunEcho(int port)
+{
+    Server server;
+
+    NetServerInit(&server, port);
+
+    printf("echo on port %d\n", port);
+
+    while (1) Echo(&server);
+}
+
+// 'server' is answered in between when pinging over loopback, NULL for a remote echo server
+static void RunPing(Client *client, Server *server, int count, int non_blocking, uint32_t *times)
+{
+    int answered = 0;
+    int lost     = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        Controller          controller  = { 0 };
+        ControllerPackage   cp          = ControllerPackageCreate(controller, 1, 0, 0, i, (uint32_t)TimeUs());
+        ControllerPackage   answer;
+
+        uint64_t start = TimeUs();
+
+        NetClientSend(client, &cp, sizeof cp);
+
+        if (server) Echo(server);
+
+        int size = -1;
+
+        if (non_blocking)
+        {
+            // a remote answer that takes longer than a second is lost
+            while ((size = NetClientRecv(client, &answer, sizeof answer)) < 0 && TimeUs() - start < 1000000);
+        }
+        else
+        {
+            size = NetClientRecv(client, &answer, sizeof answer);
+        }
+
+        uint64_t end = TimeUs();
+
+        if (!ControllerPackageValid(&answer, size) || answer.sequence != (uint32_t)i)
+        {
+            lost++;
+            continue;
+        }
+
+        times[answered++] = (uint32_t)(end - start);
+    }
+
+    PrintTimes(non_blocking? "non blocking" : "blocking", times, answered, lost);
+}
+
+int main(int argc, char **argv)
+{
+    NetInit();
+
+    if (argc > 1 && !strcmp(argv[1], "echo"))
+    {
+        RunEcho(argc > 2? atoi(argv[2]) : PORT);
+        return 0;
+    }
+
+    int         remote  = argc > 2 && !strcmp(argv[1], "ping");
+    const char *ip      = remote? argv[2] : LOCAL_HOST;
+    int         port    = remote && argc > 3? atoi(argv[3]) : PORT;
+    int         count   = remote? (argc > 4? atoi(argv[4]) : 10000) : (argc > 1? atoi(argv[1]) : 100000);
+
+    Server  server;
+    Client  blocking;
+    Client  non_blocking;
+
+    if (!remote) NetServerInit(&server, port);
+
+    NetClientInit(&blocking, ip, port);
+    NetClientInit(&non_blocking, ip, port);
+    NetSetNonBlocking(non_blocking.socket);
+
+    uint32_t *times = malloc(count * sizeof *times);
+
+    printf("%d round trips to %s:%d\n", count, ip, port);
+
+    RunPing(&blocking, remote? NULL : &server, count, 0, times);
+    RunPing(&non_blocking, remote? NULL : &server, count, 1, times);
+
+    free(times);
+
+    NetClose(blocking.socket);
+    NetClose(non_blocking.socket);
+
+    if (!remote) NetClose(server.socket);
+
+    NetDeinit();
+
+    return 0;
+}
@@ -0,0 +1,3 @@
+@echo off
+cd ../bin/
+road_update_test.exe
@@ -0,0 +1,3 @@
+@echo off
+clang++ main.cc -o ../bin/road_update_test.exe ^
+ -std=c++17 -O2 -fno-exceptions -march=haswell -lmsvcrt -llibcmt -lopencv_world411
@@ -0,0 +1,3 @@
+#!/bin/sh
+# only the OpenCV headers are needed, common.cc includes them
+g++ main.cc -o ../bin/road_update_test -std=c++17 -O2 $(pkg-config --cflags opencv4)
@@ -0,0 +1,158 @@
+#include "../../lib/common.cc"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// TilemapUpdateRoad patches the road layers of the last frame instead of filling them again, ImageProcUpdate relies
+// on that giving exactly what a full TilemapFloodFillRoad gives. this drives both through random edge changes, from a
+// few tiles a frame that get patched to many that fall back to a refill, and compares the road and boundary layers,
+// the road pyramid and the road state after every frame.
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what, int test, int frame)
+{
+    if (!ok) {
+        if (failures < 20) printf("FAIL %s (test %d, frame %d)\n", what, test, frame);
+        failures++;
+    }
+}
+
+static bool SameLayer(const uint8_t *a, const uint8_t *b, int size)
+{
+    for (int i = 0; i < size; ++i) {
+        if ((a[i] != 0) != (b[i] != 0)) return false;
+    }
+
+    return true;
+}
+
+static bool SamePyramid(const TilemapPyramid *a, const TilemapPyramid *b)
+{
+    for (int level = 0; level < PYRAMID_LEVELS; ++level) {
+        if (a->width[level] != b->width[level] || a->height[level] != b->height[level]) return false;
+
+        if (memcmp(a->cells[level], b->cells[level], a->width[level] * a->height[level])) return false;
+    }
+
+    return true;
+}
+
+// a road between two walls with a crossing wall that has gaps, the rest of the edges come from the frames
+static void SceneCreate(uint8_t *scene, int width, int height)
+{
+    memset(scene, 0, width * height);
+
+    int left  = width / 5;
+    int right = width - 1 - width / 5;
+    int cross = height / 3;
+
+    for (int y = 0; y < height; ++y) {
+        scene[y * width + left]  = 255;
+        scene[y * width + right] = 255;
+    }
+
+    for (int x = 0; x < width; ++x) {
+        if ((x / 4) % 3) scene[cross * width + x] = 255;
+    }
+}
+
+// changes 'count' random tiles, most of them next to an edge where they can open or close the road
+static void SceneChange(uint8_t *scene, int width, int height, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        int x = rand() % width;
+        int y = rand() % height;
+
+        if (rand() % 4) {
+            // walk to the next edge in the row and flip a tile next to it
+            while (x < width - 1 && !scene[y * width + x]) x++;
+
+            int nx = x + rand() % 3 - 1;
+
+            x = CLAMP(nx, 0, width - 1);
+        }
+
+        scene[y * width + x] = scene[y * width + x]? 0 : 1 + rand() % 255;
+    }
+}
+
+static void TestUpdateRoad(int test, int image_width, int image_height, int cell_size, int frames)
+{
+    Tilemap patched = {0};
+    Tilemap filled  = {0};
+
+    TilemapResize(&patched, image_width, image_height, cell_size);
+    TilemapResize(&filled,  image_width, image_height, cell_size);
+
+    TilemapClear(&patched);
+
+    int width  = patched.width;
+    int height = patched.height;
+    int size   = width * height;
+
+    int start_x     = width / 2;
+    int start_y     = height - 1;
+    int max_changes = size / 32;
+
+    uint8_t *scene = (uint8_t *)malloc(size);
+
+    SceneCreate(scene, width, height);
+
+    int patches = 0;
+    int refills = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        // mostly a few tiles like consecutive camera frames, sometimes more than max_changes
+        int r     = rand() % 100;
+        int count = (r < 70)? rand() % 4 : (r < 95)? rand() % max_changes : max_changes + rand() % size;
+
+        SceneChange(scene, width, height, count);
+
+        if (rand() % 500 == 0) SceneCreate(scene, width, height);
+
+        // like ImageProcUpdate, the road layers are kept
+        TilemapClearLayer(&patched, LAYER_EDGE);
+        TilemapClearLayer(&patched, LAYER_OVERLAY);
+
+        memcpy(patched.edge, scene, size);
+
+        int result = TilemapUpdateRoad(&patched, start_x, start_y, max_changes);
+
+        if (result >= 0) patches++;
+        else             refills++;
+
+        TilemapClear(&filled);
+
+        memcpy(filled.edge, scene, size);
+
+        TilemapFloodFillRoad(&filled, start_x, start_y);
+
+        Check(SameLayer(patched.road, filled.road, size), "road layer", test, frame);
+        Check(SameLayer(patched.boundary, filled.boundary, size), "boundary layer", test, frame);
+        Check(patched.has_road_pyramid && SamePyramid(&patched.road_pyramid, &filled.road_pyramid), "road pyramid",
+              test, frame);
+        Check(TilemapGetRoadState(&patched) == TilemapGetRoadState(&filled), "road state", test, frame);
+        Check(TilemapGetRoadHeight(&patched) == TilemapGetRoadHeight(&filled), "road height", test, frame);
+    }
+
+    printf("%dx%d tiles, %d frames: %d patched, %d filled again\n", width, height, frames, patches, refills);
+
+    free(scene);
+}
+
+int main(void)
+{
+    srand(1);
+
+    int test = 0;
+
+    TestUpdateRoad(test++, 320, 240, 8, 18000);
+    TestUpdateRoad(test++, 344, 296, 8, 6000);      // not a multiple of the pyramid blocks
+    TestUpdateRoad(test++, 320, 240, 16, 6000);
+
+    if (failures) printf("%d failures\n", failures);
+    else          puts("all the same");
+
+    return failures != 0;
+}
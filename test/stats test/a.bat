@@ -0,0 +1,3 @@
+@echo off
+cd ../bin/
+stats_test.exe
@@ -0,0 +1,3 @@
+@echo off
+clang++ main.cc -o ../bin/stats_test.exe ^
+ -std=c++17 -O2 -march=haswell
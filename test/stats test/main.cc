@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cmath>
+#include <vector>
+
+#include "../../lib/klass.cc"
+
+// compares the streaming statistics against recomputing everything from the full history after every push, the
+// compile time window sizes against the runtime ones, and the millisecond windows against the frame windows.
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what, int test, int step)
+{
+    if (!ok) {
+        if (failures < 20) printf("FAIL %s (test %d, step %d)\n", what, test, step);
+        failures++;
+    }
+}
+
+static bool Near(double a, double b)
+{
+    return fabs(a - b) <= 1e-4 * (1.0 + fabs(b));
+}
+
+static void TestStreamStats(int test, int window, int diff_window, float alpha)
+{
+    StreamStats<DYNAMIC_WINDOW, DYNAMIC_WINDOW> stats;
+    stats.init(window, diff_window, alpha);
+
+    std::vector<float> history;
+    float ema = 0;
+
+    for (int step = 0; step < 5000; ++step) {
+        float x = (rand() % 2001 - 1000) / 1000.0f;
+
+        // slow drifts and jumps like a road position
+        if (step % 700 < 300) x = 0.1f * x + sinf(step * 0.01f);
+
+        stats.push(x);
+        history.push_back(x);
+
+        ema = (step == 0)? x : ema + alpha * (x - ema);
+
+        int n = (int)history.size() < window? (int)history.size() : window;
+
+        double sum = 0;
+        double sum_sq = 0;
+
+        for (int i = 0; i < n; ++i) {
+            double v = history[history.size() - 1 - i];
+            sum += v;
+            sum_sq += v * v;
+        }
+
+        double mean = sum / n;
+        double variance = sum_sq / n - mean * mean;
+
+        // average of the last differences, the way InterPosList used to compute it
+        int span = (int)history.size() - 1 < diff_window? (int)history.size() - 1 : diff_window;
+        double dif_sum = 0;
+
+        for (int i = 0; i < span; ++i) {
+            dif_sum += history[history.size() - 1 - i] - history[history.size() - 2 - i];
+        }
+
+        double derivative = span? dif_sum / span : 0;
+
+        Check(Near(stats.mean(), mean), "mean", test, step);
+        Check(Near(stats.variance(), variance > 0? variance : 0), "variance", test, step);
+        Check(Near(stats.ema, ema), "ema", test, step);
+        Check(Near(stats.derivative(), derivative), "derivative", test, step);
+    }
+}
+
+static void TestTypeCounts(int test, int window)
+{
+    TypeCounts<DYNAMIC_WINDOW> counts;
+    counts.init(window);
+
+    std::vector<int> history;
+
+    for (int step = 0; step < 5000; ++step) {
+        // runs of the same type with some noise, like the classified road state
+        int type = ((step / 37) % 5) * 2 + 1;
+
+        if (rand() % 4 == 0) type = rand() % 16;
+
+        counts.push(type);
+        history.push_back(type);
+
+        int n = (int)history.size() < window? (int)history.size() : window;
+        int naive[TypeCounts<DYNAMIC_WINDOW>::typeCount] = {};
+        int max_count = 0;
+
+        for (int i = 0; i < n; ++i) {
+            int t = history[history.size() - 1 - i];
+            naive[t]++;
+            if (naive[t] > max_count) max_count = naive[t];
+        }
+
+        for (int t = 0; t < TypeCounts<DYNAMIC_WINDOW>::typeCount; ++t) {
+            Check(counts.get(t) == naive[t], "type count", test, step);
+        }
+
+        Check(naive[counts.mode()] == max_count, "mode", test, step);
+    }
+}
+
+// frame times jumping between min_dt and max_dt ms, the windows are checked against the samples with timestamps in
+// range, and at a steady frame time against the frame count windows.
+static void TestTimedStats(int test, uint32_t window_ms, uint32_t diff_ms, int min_dt, int max_dt)
+{
+    TimedStats<> stats;
+    stats.init(window_ms, diff_ms);
+
+    TimedTypeCounts<> counts;
+    counts.init(window_ms);
+
+    std::vector<float>    history;
+    std::vector<int>      types;
+    std::vector<uint32_t> times;
+
+    // starts just below the wrap of the millisecond clock
+    uint32_t time = 0xFFFFFFFF - 5000;
+
+    for (int step = 0; step < 5000; ++step) {
+        float x = (rand() % 2001 - 1000) / 1000.0f;
+        int   type = ((step / 37) % 5) * 2 + 1;
+
+        if (step % 700 < 300) x = 0.1f * x + sinf(step * 0.01f);
+        if (rand() % 4 == 0)  type = rand() % 16;
+
+        time += min_dt + rand() % (max_dt - min_dt + 1);
+
+        stats.push(time, x);
+        counts.push(time, type);
+        history.push_back(x);
+        types.push_back(type);
+        times.push_back(time);
+
+        int n = 0;
+        int naive[TimedTypeCounts<>::typeCount] = {};
+        double sum = 0;
+
+        // the newest sample is always in the window, the ring holds at most capacity
+        for (int i = (int)history.size() - 1; i >= 0 && n < TimedStats<>::capacity &&
+                                              (n == 0 || time - times[i] < window_ms); --i, ++n) {
+            sum += history[i];
+            naive[types[i]]++;
+        }
+
+        int oldest = (int)history.size() - 1;
+        while (oldest > 0 && time - times[oldest - 1] <= diff_ms) oldest--;
+
+        uint32_t dt = time - times[oldest];
+        double derivative = dt? (history.back() - history[oldest]) / dt : 0;
+
+        Check(stats.size() == n, "timed size", test, step);
+        Check(Near(stats.mean(), sum / n), "timed mean", test, step);
+        Check(Near(stats.derivative(), derivative), "timed derivative", test, step);
+
+        for (int t = 0; t < TimedTypeCounts<>::typeCount; ++t) {
+            Check(counts.get(t) == naive[t], "timed type count", test, step);
+        }
+    }
+}
+
+static void TestTimedMatchesFrames(int test, int window, int diff_window, int frame_ms)
+{
+    TimedStats<> timed;
+    timed.init(window * frame_ms, diff_window * frame_ms);
+
+    StreamStats<DYNAMIC_WINDOW, DYNAMIC_WINDOW> frames;
+    frames.init(window, diff_window, 0.2f);
+
+    for (int step = 0; step < 2000; ++step) {
+        float x = sinf(step * 0.05f) + (rand() % 100) * 0.001f;
+
+        timed.push(1000 + step * frame_ms, x);
+        frames.push(x);
+
+        Check(timed.size() == frames.size(), "steady size", test, step);
+        Check(Near(timed.mean(), frames.mean()), "steady mean", test, step);
+        Check(Near(timed.derivative() * frame_ms, frames.derivative()), "steady derivative", test, step);
+    }
+}
+
+// the compile time sizes have to give exactly the same results as the same sizes set at runtime. sizes beyond what
+// the dynamic rings hold are clamped to it
+template <int Window, int DiffWindow>
+static void TestStaticMatchesDynamic(int test, int window = Window, int diff_window = DiffWindow)
+{
+    InterPosList<Window, DiffWindow> fixed;
+    InterPosListDynamic dynamic;
+
+    dynamic.init(window, diff_window);
+
+    Check(dynamic.maxSize() == Window, "dynamic window", test, 0);
+    Check(dynamic.posStats.diffWindow.get() == DiffWindow, "dynamic diff window", test, 0);
+
+    for (int step = 0; step < 5000; ++step) {
+        InterPos in = { ((step / 50) % 4) * 2 + 1, sinf(step * 0.02f) + (rand() % 100) * 0.001f };
+
+        if (rand() % 5 == 0) in.type = rand() % 16;
+
+        fixed.push(in);
+        dynamic.push(in);
+
+        fixed.analyze();
+        dynamic.analyze();
+
+        Check(fixed.pos == dynamic.pos, "static pos", test, step);
+        Check(fixed.type == dynamic.type, "static type", test, step);
+        Check(fixed.posDifAvg == dynamic.posDifAvg, "static posDifAvg", test, step);
+        Check(fixed.blink == dynamic.blink, "static blink", test, step);
+    }
+}
+
+int main(void)
+{
+    srand(1);
+
+    int test = 0;
+
+    TestStreamStats(test++, 10, 5, 0.2f);
+    TestStreamStats(test++, 1, 1, 1.0f);
+    TestStreamStats(test++, 64, 63, 0.05f);
+    TestStreamStats(test++, 30, 10, 0.5f);
+
+    TestTypeCounts(test++, 10);
+    TestTypeCounts(test++, 1);
+    TestTypeCounts(test++, 64);
+
+    TestStaticMatchesDynamic<10, 5>(test++);
+    TestStaticMatchesDynamic<4, 8>(test++);
+    TestStaticMatchesDynamic<32, 16>(test++);
+    TestStaticMatchesDynamic<DYNAMIC_CAPACITY, DYNAMIC_CAPACITY - 1>(test++, 1000, 500);
+    TestStaticMatchesDynamic<DYNAMIC_CAPACITY, DYNAMIC_CAPACITY - 1>(test++, DYNAMIC_CAPACITY, DYNAMIC_CAPACITY);
+    TestStaticMatchesDynamic<1, 1>(test++, -5, 0);
+
+    TestTimedStats(test++, 330, 165, 10, 40);
+    TestTimedStats(test++, 100, 300, 1, 60);
+    TestTimedStats(test++, 2000, 50, 5, 15);     // more samples than the ring holds
+
+    TestTimedMatchesFrames(test++, 10, 5, 33);
+    TestTimedMatchesFrames(test++, 4, 8, 20);
+
+    if (failures) printf("%d failures\n", failures);
+    else          puts("all passed");
+
+    return failures != 0;
+}